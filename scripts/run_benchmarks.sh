@@ -53,4 +53,49 @@ for f in ./data/midi_examples/*; do
   echo "Total memory use: $mem_use bytes"
   echo
 
+  echo "Running massif peak heap comparison (ifstream vs mmap)"
+  for mode in "" "--mmap"; do
+    valgrind --tool=massif -q \
+             --massif-out-file="massif.heap$mode.$(basename $f).out" \
+            ./buildRelease/tools/benchmark $mode $f
+    heap_use=$(grep mem_heap_B "massif.heap$mode.$(basename $f).out" \
+            | sed -e 's/mem_heap_B=\(.*\)/\1/' \
+            | sort -g \
+            | tail -n 1)
+    echo "Peak heap use ${mode:-ifstream}: $heap_use bytes"
+  done
+  echo
+
 done
+
+# Throughput of the event readers, the example files and synthetic scaling
+# cases, written to benchmark.json for comparison across commits, e.g. with
+# Google Benchmark's tools/compare.py.
+echo
+echo "Running parser_benchmark"
+./buildRelease/tools/parser_benchmark --benchmark_out=benchmark.json \
+                                      --benchmark_out_format=json
+
+# Set BASELINE to the build directory of another revision, e.g.
+# `BASELINE=./buildBaseline ./scripts/run_benchmarks.sh`, to compare its
+# instruction counts with ./buildRelease on every example file.
+if [ -n "$BASELINE" ]; then
+  echo
+  echo "Callgrind instruction counts: $BASELINE vs ./buildRelease"
+  printf "%-16s %16s %16s %8s\n" "file" "baseline Ir" "current Ir" "ratio"
+  for f in ./data/midi_examples/*; do
+    counts=()
+    for build in "$BASELINE" ./buildRelease; do
+      valgrind --tool=callgrind -q \
+               --callgrind-out-file="callgrind.compare.out" \
+              $build/tools/benchmark $f
+      counts+=($(callgrind_annotate "callgrind.compare.out" \
+              | grep "PROGRAM TOTALS" \
+              | awk '{print $1}' \
+              | tr -d ','))
+    done
+    printf "%-16s %16s %16s %8.3f\n" "$(basename $f)" "${counts[0]}" \
+           "${counts[1]}" "$(echo "${counts[1]} / ${counts[0]}" | bc -l)"
+  done
+  rm -f callgrind.compare.out
+fi
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "NoteTable.hpp"
+#include "ParseError.hpp"
+#include "TempoMap.hpp"
+#include "enums.hpp"
+#include "events.hpp"
+
+namespace MidiParser {
+
+/**
+ * A representation of a MIDI file as columns of events, used as the output
+ * of MidiParser::Parser::parseColumnar. Event `i` of the file is made up of
+ * the `i`th element of each column, so scanning one property of all events
+ * reads one contiguous array, as auto-vectorized filters and aggregations
+ * want:
+ *
+ * `for (size_t i = 0; i < f.size(); ++i) {`
+ * `  noteOns += (f.status[i] & 0xF0) == 0x90 && f.data2[i] != 0;`
+ * `}`
+ *
+ * The events of all tracks are stored one track after another, in the order
+ * of the track chunks.
+ */
+struct ColumnarMidiFile {
+
+  /**
+   * The format of a MIDI file. See `MidiParser::MidiFile::fileFormat`.
+   */
+  uint16_t fileFormat;
+
+  /**
+   * The number of track chunks to be found as declared in the header chunk.
+   */
+  uint16_t numTracks;
+
+  /**
+   * Unit of time used in the delta times. See
+   * `MidiParser::MidiFile::tickDivision`.
+   */
+  uint16_t tickDivision;
+
+  /**
+   * The absolute time of each event in ticks.
+   */
+  std::vector<uint64_t> tick;
+
+  std::vector<EventKind> kind;
+
+  /**
+   * Same meaning as `MidiParser::EventView::status`.
+   */
+  std::vector<uint8_t> status;
+
+  /**
+   * The first and second data byte of each MIDI event, or `0` if it has
+   * fewer. Always `0` for meta and SysEx events.
+   */
+  std::vector<uint8_t> data1;
+  std::vector<uint8_t> data2;
+
+  /**
+   * The index of each event's track.
+   */
+  std::vector<uint16_t> track;
+
+  /**
+   * The data of meta or SysEx event `i` are the bytes of `payload` from
+   * `payloadOffsets[i]` up to `payloadOffsets[i + 1]`. Has one element more
+   * than there are events, the first being `0`.
+   */
+  std::vector<uint32_t> payloadOffsets = {0};
+
+  /**
+   * The concatenated data of all meta and SysEx events.
+   */
+  std::vector<uint8_t> payload;
+
+  /**
+   * The index of the first event of each track, followed by the number of
+   * events.
+   */
+  std::vector<size_t> trackOffsets = {0};
+
+  /**
+   * The tempo map shared by all tracks. Only present when parsing with
+   * `ParseOptions::buildTimeIndex`, and never for format 2 files. See
+   * `MidiParser::MidiFile::tempoMap`.
+   */
+  std::optional<TempoMap> tempoMap;
+
+  /**
+   * The notes of all tracks ordered by start tick. Only present when parsing
+   * with `ParseOptions::pairNotes`.
+   */
+  std::optional<NoteTable> notes;
+
+  /**
+   * The errors that cut tracks short when parsing with
+   * `ParseOptions::lenient`, at most one per track, ordered by track.
+   */
+  std::vector<ParseError> errors;
+
+  /**
+   * The number of events.
+   */
+  size_t size() const { return tick.size(); }
+
+  /**
+   * The data of the meta or SysEx event at `index`.
+   */
+  std::span<const uint8_t> payloadData(size_t index) const {
+    return std::span(payload).subspan(
+        payloadOffsets[index],
+        payloadOffsets[index + 1] - payloadOffsets[index]);
+  }
+
+  /**
+   * Returns a copy of the event at `index` as a `MidiParser::TrackEvent`,
+   * with its delta time measured from the previous event of its track.
+   */
+  TrackEvent event(size_t index) const {
+    uint32_t deltaTime = static_cast<uint32_t>(
+        index == trackOffsets[track[index]] ? tick[index]
+                                            : tick[index] - tick[index - 1]);
+    if (kind[index] == EventKind::MIDI) {
+      std::vector<uint8_t> data = {data1[index], data2[index]};
+      data.resize(STATUS_TABLE[status[index]].dataLength);
+      return MIDIEvent{deltaTime, status[index], std::move(data)};
+    }
+    auto bytes = payloadData(index);
+    std::vector<uint8_t> data(bytes.begin(), bytes.end());
+    if (kind[index] == EventKind::META) {
+      return MetaEvent{deltaTime, status[index], std::move(data)};
+    }
+    return SysExEvent{deltaTime, std::move(data)};
+  }
+
+  bool operator==(const ColumnarMidiFile&) const = default;
+};
+
+}  // namespace MidiParser
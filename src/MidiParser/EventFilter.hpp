@@ -0,0 +1,93 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+
+#include "enums.hpp"
+#include "events.hpp"
+
+namespace MidiParser {
+
+/**
+ * Selects which events a `MidiParser::Parser` keeps. Events that are not
+ * accepted are skipped over without being copied, and the delta time of the
+ * next kept event grows by theirs, so kept events stay at their original
+ * times.
+ *
+ * Example usage, keeping only note on and note off messages:
+ *
+ * `auto filter = MidiParser::EventFilter::none()`
+ * `                  .keepChannelMessages(0x80)`
+ * `                  .keepChannelMessages(0x90);`
+ */
+struct EventFilter {
+
+  /**
+   * The status bytes of the MIDI events to keep.
+   */
+  std::bitset<256> midi;
+
+  /**
+   * The types of the meta events to keep.
+   */
+  std::bitset<256> meta;
+
+  /**
+   * Whether to keep SysEx events.
+   */
+  bool sysEx = false;
+
+  /**
+   * A filter that keeps every event.
+   */
+  static EventFilter all() {
+    EventFilter f;
+    f.midi.set();
+    f.meta.set();
+    f.sysEx = true;
+    return f;
+  }
+
+  /**
+   * A filter that keeps no events, to be widened with the `keep` functions.
+   */
+  static EventFilter none() { return EventFilter{}; }
+
+  /**
+   * Also keeps the channel messages whose status has the same upper nibble as
+   * `status`, on all 16 channels.
+   */
+  EventFilter& keepChannelMessages(uint8_t status) {
+    for (int channel = 0; channel < 16; ++channel) {
+      midi.set((status & 0xF0) | channel);
+    }
+    return *this;
+  }
+
+  /**
+   * Also keeps meta events of the given type.
+   */
+  EventFilter& keepMeta(Meta type) {
+    meta.set(static_cast<uint8_t>(type));
+    return *this;
+  }
+
+  /**
+   * Whether `e` is kept.
+   */
+  bool accepts(const EventView& e) const {
+    switch (e.kind) {
+      case EventKind::MIDI:
+        return midi[e.status];
+      case EventKind::META:
+        return meta[e.status];
+      case EventKind::SYSEX:
+        break;
+    }
+    return sysEx;
+  }
+
+  bool operator==(const EventFilter&) const = default;
+};
+
+}  // namespace MidiParser
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace MidiParser {
+
+/**
+ * The hooks called by the handler overloads of `MidiParser::Parser::parse`.
+ * A handler derives from this and hides the hooks it needs; the others do
+ * nothing. Hooks are looked up at compile time, not through virtual calls,
+ * so they inline into the decode loop.
+ *
+ * The spans passed to the hooks point into the file's bytes and are only
+ * valid during the call.
+ *
+ * Example usage:
+ *
+ * `struct NoteCounter : MidiParser::EventHandler {`
+ * `  size_t notes = 0;`
+ * `  void onMidiEvent(uint32_t, uint8_t status, std::span<const uint8_t>) {`
+ * `    notes += (status & 0xF0) == 0x90;`
+ * `  }`
+ * `};`
+ */
+struct EventHandler {
+  /**
+   * Called once with the fields of the header chunk, before any track.
+   */
+  void onHeader(uint16_t fileFormat, uint16_t numTracks,
+                uint16_t tickDivision) {}
+
+  /**
+   * Called before the events of the track at index `track`.
+   */
+  void onTrackBegin(size_t track) {}
+
+  /**
+   * Called for a MIDI event with its status byte and data bytes.
+   */
+  void onMidiEvent(uint32_t deltaTime, uint8_t status,
+                   std::span<const uint8_t> data) {}
+
+  /**
+   * Called for a meta event with its type and data.
+   */
+  void onMeta(uint32_t deltaTime, uint8_t type, std::span<const uint8_t> data) {
+  }
+
+  /**
+   * Called for a SysEx event with the bytes between its status and `F7`.
+   */
+  void onSysEx(uint32_t deltaTime, std::span<const uint8_t> data) {}
+
+  /**
+   * Called after the last event of the track at index `track`.
+   */
+  void onTrackEnd(size_t track) {}
+};
+
+}  // namespace MidiParser
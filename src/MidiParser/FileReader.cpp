@@ -0,0 +1,591 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && !defined(MIDIPARSER_NO_IO_URING) && \
+    __has_include(<linux/io_uring.h>)
+#define MIDIPARSER_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "FileReader.hpp"
+#include "ThreadPool.hpp"
+
+namespace MidiParser {
+
+namespace {
+
+/**
+ * A file opened for reading, closed again when the handle is destroyed.
+ */
+class FileHandle {
+ public:
+  /**
+   * Opens the file located at `path`. Throws `std::ios_base::failure` if the
+   * file cannot be opened or its size cannot be read.
+   */
+  explicit FileHandle(const std::string& path);
+  ~FileHandle();
+
+  FileHandle(const FileHandle&) = delete;
+  FileHandle& operator=(const FileHandle&) = delete;
+
+  size_t size() const { return m_size; }
+
+  /**
+   * Reads up to `length` bytes at `offset` into `buffer`, blocking until
+   * they have arrived. Returns the number of bytes read, or a negative
+   * error code.
+   */
+  int64_t readAt(std::byte* buffer, size_t length, uint64_t offset) const;
+
+#ifdef MIDIPARSER_IO_URING
+  int descriptor() const { return m_fd; }
+#endif
+
+ private:
+  size_t m_size = 0;
+
+#ifdef _WIN32
+  void* m_file = nullptr;
+#else
+  int m_fd = -1;
+#endif
+};
+
+#ifdef _WIN32
+
+FileHandle::FileHandle(const std::string& path) {
+  m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                       OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) {
+    m_file = nullptr;
+    throw std::ios_base::failure("Unable to open file.");
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size)) {
+    CloseHandle(m_file);
+    throw std::ios_base::failure("Unable to read file size.");
+  }
+  m_size = static_cast<size_t>(size.QuadPart);
+}
+
+FileHandle::~FileHandle() {
+  CloseHandle(m_file);
+}
+
+int64_t FileHandle::readAt(std::byte* buffer, size_t length,
+                           uint64_t offset) const {
+  OVERLAPPED position{};
+  position.Offset = static_cast<DWORD>(offset);
+  position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+  DWORD read = 0;
+  if (!ReadFile(m_file, buffer, static_cast<DWORD>(length), &read,
+                &position)) {
+    DWORD error = GetLastError();
+    return error == ERROR_HANDLE_EOF ? 0 : -static_cast<int64_t>(error);
+  }
+  return read;
+}
+
+#else
+
+FileHandle::FileHandle(const std::string& path) {
+  m_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (m_fd == -1) {
+    throw std::ios_base::failure("Unable to open file.");
+  }
+  struct stat info;
+  if (fstat(m_fd, &info) == -1) {
+    close(m_fd);
+    throw std::ios_base::failure("Unable to read file size.");
+  }
+  m_size = static_cast<size_t>(info.st_size);
+  posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+FileHandle::~FileHandle() {
+  close(m_fd);
+}
+
+int64_t FileHandle::readAt(std::byte* buffer, size_t length,
+                           uint64_t offset) const {
+  ssize_t read;
+  do {
+    read = pread(m_fd, buffer, length, static_cast<off_t>(offset));
+  } while (read == -1 && errno == EINTR);
+  return read == -1 ? -errno : read;
+}
+
+#endif
+
+/**
+ * The result of a read: the tag it was submitted with and the number of
+ * bytes read, or a negative error code.
+ */
+struct ReadResult {
+  uint64_t tag;
+  int64_t bytes;
+};
+
+/**
+ * Issues reads and collects their results. The reader never has more reads
+ * outstanding than the queue depth it was created with.
+ */
+class ReadQueue {
+ public:
+  virtual ~ReadQueue() = default;
+
+  /**
+   * Queues a read of `length` bytes at `offset` of `file` into `buffer`,
+   * whose result is reported with `tag`. `file` and `buffer` must stay alive
+   * until then.
+   */
+  virtual void submit(uint64_t tag, const FileHandle& file, std::byte* buffer,
+                      size_t length, uint64_t offset) = 0;
+
+  /**
+   * Starts the queued reads, waits until at least one read has completed and
+   * appends the results of all completed reads to `results`.
+   */
+  virtual void wait(std::vector<ReadResult>& results) = 0;
+};
+
+/**
+ * Runs blocking reads on threads of its own.
+ */
+class ThreadQueue final : public ReadQueue {
+ public:
+  explicit ThreadQueue(size_t threads)
+      : m_threads(threads), m_group(m_threads) {}
+
+  void submit(uint64_t tag, const FileHandle& file, std::byte* buffer,
+              size_t length, uint64_t offset) override {
+    m_group.run([this, tag, &file, buffer, length, offset] {
+      int64_t bytes = file.readAt(buffer, length, offset);
+      std::lock_guard lock(m_mutex);
+      m_results.emplace_back(tag, bytes);
+      m_done.notify_one();
+    });
+  }
+
+  void wait(std::vector<ReadResult>& results) override {
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [this] { return !m_results.empty(); });
+    results.insert(results.end(), m_results.begin(), m_results.end());
+    m_results.clear();
+  }
+
+ private:
+  std::mutex m_mutex;
+  std::condition_variable m_done;
+  std::vector<ReadResult> m_results;
+  // Destroyed first, waiting for the reads still touching the members above.
+  ThreadPool m_threads;
+  TaskGroup m_group;
+};
+
+#ifdef MIDIPARSER_IO_URING
+
+/**
+ * Submits reads to the kernel through an io_uring submission queue and
+ * collects them from its completion queue, both shared with the kernel
+ * through memory mappings of the ring.
+ */
+class UringQueue final : public ReadQueue {
+ public:
+  /**
+   * Sets up a ring for `depth` reads, or returns `nullptr` if the kernel
+   * does not offer io_uring with the plain read operation of Linux 5.6.
+   */
+  static std::unique_ptr<UringQueue> create(unsigned depth);
+
+  ~UringQueue() override;
+
+  void submit(uint64_t tag, const FileHandle& file, std::byte* buffer,
+              size_t length, uint64_t offset) override;
+  void wait(std::vector<ReadResult>& results) override;
+
+ private:
+  int m_ring = -1;
+  void* m_rings = MAP_FAILED;
+  size_t m_ringsSize = 0;
+  io_uring_sqe* m_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+  size_t m_sqesSize = 0;
+
+  unsigned* m_sqTail;
+  unsigned m_sqMask;
+  unsigned* m_sqArray;
+  unsigned* m_cqHead;
+  unsigned* m_cqTail;
+  unsigned m_cqMask;
+  io_uring_cqe* m_cqes;
+
+  /**
+   * Reads queued since the last `io_uring_enter` call.
+   */
+  unsigned m_unsubmitted = 0;
+
+  UringQueue() = default;
+
+  /**
+   * Hands the queued reads to the kernel and, with `wait`, blocks until at
+   * least one has completed.
+   */
+  void enter(bool wait);
+};
+
+std::unique_ptr<UringQueue> UringQueue::create(unsigned depth) {
+  std::unique_ptr<UringQueue> queue(new UringQueue);
+  io_uring_params params{};
+  queue->m_ring = static_cast<int>(
+      syscall(__NR_io_uring_setup, std::clamp(depth, 1u, 4096u), &params));
+  // IORING_FEAT_RW_CUR_POS came with IORING_OP_READ in Linux 5.6.
+  if (queue->m_ring < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP) ||
+      !(params.features & IORING_FEAT_RW_CUR_POS)) {
+    return nullptr;
+  }
+  queue->m_ringsSize =
+      std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+               params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  queue->m_rings = mmap(nullptr, queue->m_ringsSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, queue->m_ring,
+                        IORING_OFF_SQ_RING);
+  queue->m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  queue->m_sqes = static_cast<io_uring_sqe*>(
+      mmap(nullptr, queue->m_sqesSize, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, queue->m_ring, IORING_OFF_SQES));
+  if (queue->m_rings == MAP_FAILED || queue->m_sqes == MAP_FAILED) {
+    return nullptr;
+  }
+  auto* rings = static_cast<char*>(queue->m_rings);
+  auto at = [rings](uint32_t offset) {
+    return reinterpret_cast<unsigned*>(rings + offset);
+  };
+  queue->m_sqTail = at(params.sq_off.tail);
+  queue->m_sqMask = *at(params.sq_off.ring_mask);
+  queue->m_sqArray = at(params.sq_off.array);
+  queue->m_cqHead = at(params.cq_off.head);
+  queue->m_cqTail = at(params.cq_off.tail);
+  queue->m_cqMask = *at(params.cq_off.ring_mask);
+  queue->m_cqes = reinterpret_cast<io_uring_cqe*>(rings + params.cq_off.cqes);
+  return queue;
+}
+
+UringQueue::~UringQueue() {
+  if (m_sqes != MAP_FAILED) {
+    munmap(m_sqes, m_sqesSize);
+  }
+  if (m_rings != MAP_FAILED) {
+    munmap(m_rings, m_ringsSize);
+  }
+  if (m_ring >= 0) {
+    close(m_ring);
+  }
+}
+
+void UringQueue::submit(uint64_t tag, const FileHandle& file,
+                        std::byte* buffer, size_t length, uint64_t offset) {
+  // Only this thread writes the tail, so it can be read plainly. Storing it
+  // with release semantics publishes the entry to the kernel.
+  unsigned tail = *m_sqTail;
+  unsigned index = tail & m_sqMask;
+  io_uring_sqe& sqe = m_sqes[index];
+  sqe = io_uring_sqe{};
+  sqe.opcode = IORING_OP_READ;
+  sqe.fd = file.descriptor();
+  sqe.addr = reinterpret_cast<uint64_t>(buffer);
+  sqe.len = static_cast<uint32_t>(length);
+  sqe.off = offset;
+  sqe.user_data = tag;
+  m_sqArray[index] = index;
+  std::atomic_ref(*m_sqTail).store(tail + 1, std::memory_order_release);
+  ++m_unsubmitted;
+}
+
+void UringQueue::enter(bool wait) {
+  while (m_unsubmitted > 0 || wait) {
+    long submitted =
+        syscall(__NR_io_uring_enter, m_ring, m_unsubmitted, wait ? 1 : 0,
+                wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+    if (submitted < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::system_category(),
+                              "io_uring_enter failed");
+    }
+    m_unsubmitted -= static_cast<unsigned>(submitted);
+    wait = false;
+  }
+}
+
+void UringQueue::wait(std::vector<ReadResult>& results) {
+  enter(false);
+  while (true) {
+    // Only this thread advances the head. The tail is written by the kernel
+    // and read with acquire semantics to see the entries before it.
+    unsigned head = *m_cqHead;
+    unsigned tail = std::atomic_ref(*m_cqTail).load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+      results.emplace_back(cqe.user_data, cqe.res);
+    }
+    std::atomic_ref(*m_cqHead).store(head, std::memory_order_release);
+    if (!results.empty()) {
+      return;
+    }
+    enter(true);
+  }
+}
+
+#endif
+
+/**
+ * Creates the queue for `backend`.
+ */
+std::unique_ptr<ReadQueue> makeQueue(
+    [[maybe_unused]] FileReader::Backend backend,
+    const FileReaderOptions& options) {
+#ifdef MIDIPARSER_IO_URING
+  if (backend == FileReader::Backend::IO_URING) {
+    if (auto queue =
+            UringQueue::create(static_cast<unsigned>(options.queueDepth))) {
+      return queue;
+    }
+  }
+#endif
+  return std::make_unique<ThreadQueue>(std::max<size_t>(options.ioThreads, 1));
+}
+
+/**
+ * A file that is being read.
+ */
+struct OpenFile {
+  size_t index;
+  FileHandle handle;
+  std::byte* buffer;
+
+  /**
+   * The start of the part of the file no read has been issued for yet.
+   */
+  size_t requested = 0;
+
+  /**
+   * Whether each block has arrived completely.
+   */
+  std::vector<bool> blocksDone;
+
+  /**
+   * The number of blocks at the start of the file that have arrived.
+   */
+  size_t arrivedBlocks = 0;
+
+  size_t inFlight = 0;
+  std::exception_ptr error;
+
+  OpenFile(size_t fileIndex, const std::string& path)
+      : index(fileIndex), handle(path) {}
+};
+
+/**
+ * A read in flight, for part of one block of a file.
+ */
+struct PendingRead {
+  OpenFile* file;
+  size_t block;
+  size_t offset;
+  size_t length;
+};
+
+}  // namespace
+
+FileReader::FileReader(const FileReaderOptions& options)
+    : m_options(options), m_backend(Backend::THREADS) {
+  m_options.queueDepth = std::clamp<size_t>(m_options.queueDepth, 1, 4096);
+  // A single read is limited to what fits a 32-bit length.
+  m_options.blockSize =
+      std::clamp<size_t>(m_options.blockSize, 1, size_t{1} << 30);
+  m_options.maxOpenFiles = std::max<size_t>(m_options.maxOpenFiles, 1);
+#ifdef MIDIPARSER_IO_URING
+  if (m_options.useIoUring && UringQueue::create(1)) {
+    m_backend = Backend::IO_URING;
+  }
+#endif
+}
+
+void FileReader::read(std::span<const std::string> paths,
+                      const OpenCallback& open,
+                      const ProgressCallback& progress,
+                      const FailCallback& fail) const {
+  auto queue = makeQueue(m_backend, m_options);
+  const size_t blockSize = m_options.blockSize;
+  std::vector<std::unique_ptr<OpenFile>> files;
+  std::vector<PendingRead> reads(m_options.queueDepth);
+  std::vector<uint64_t> freeTags;
+  for (size_t tag = reads.size(); tag-- > 0;) {
+    freeTags.emplace_back(tag);
+  }
+  size_t nextPath = 0;
+
+  auto issue = [&](OpenFile& file, size_t block, size_t offset,
+                   size_t length) {
+    uint64_t tag = freeTags.back();
+    freeTags.pop_back();
+    reads[tag] = {&file, block, offset, length};
+    ++file.inFlight;
+    queue->submit(tag, file.handle, file.buffer + offset, length, offset);
+  };
+
+  // Opens the next file, unless it fails or is empty. Returns whether one
+  // was opened.
+  auto openNext = [&] {
+    size_t index = nextPath++;
+    std::unique_ptr<OpenFile> file;
+    try {
+      file = std::make_unique<OpenFile>(index, paths[index]);
+    } catch (...) {
+      fail(index, std::current_exception());
+      return false;
+    }
+    size_t size = file->handle.size();
+    try {
+      file->buffer = open(index, size).data();
+    } catch (...) {
+      fail(index, std::current_exception());
+      return false;
+    }
+    if (size == 0) {
+      progress(index, 0);
+      return false;
+    }
+    file->blocksDone.resize((size + blockSize - 1) / blockSize);
+    files.emplace_back(std::move(file));
+    return true;
+  };
+
+  // Keeps the queue full, preferring the earliest opened files so that
+  // their starts arrive first.
+  auto fill = [&] {
+    while (!freeTags.empty()) {
+      auto it = std::ranges::find_if(files, [](const auto& f) {
+        return !f->error && f->requested < f->handle.size();
+      });
+      if (it == files.end()) {
+        if (nextPath == paths.size() ||
+            files.size() >= m_options.maxOpenFiles) {
+          return;
+        }
+        openNext();
+        continue;
+      }
+      OpenFile& file = **it;
+      size_t length = std::min(blockSize, file.handle.size() - file.requested);
+      issue(file, file.requested / blockSize, file.requested, length);
+      file.requested += length;
+    }
+  };
+
+  // Handles a completed read, reporting the file's progress.
+  auto complete = [&](const ReadResult& result) {
+    PendingRead read = reads[result.tag];
+    freeTags.emplace_back(result.tag);
+    OpenFile& file = *read.file;
+    --file.inFlight;
+    if (file.error) {
+      return;
+    }
+    if (result.bytes < 0) {
+      file.error = std::make_exception_ptr(std::system_error(
+          static_cast<int>(-result.bytes), std::system_category(),
+          "Unable to read file"));
+      return;
+    }
+    auto bytes = static_cast<size_t>(result.bytes);
+    if (bytes == 0) {
+      file.error = std::make_exception_ptr(
+          std::ios_base::failure("File ended before its size was read."));
+      return;
+    }
+    if (bytes < read.length) {
+      issue(file, read.block, read.offset + bytes, read.length - bytes);
+      return;
+    }
+    file.blocksDone[read.block] = true;
+    size_t arrived = file.arrivedBlocks;
+    while (arrived < file.blocksDone.size() && file.blocksDone[arrived]) {
+      ++arrived;
+    }
+    if (arrived != file.arrivedBlocks) {
+      file.arrivedBlocks = arrived;
+      progress(file.index, std::min(arrived * blockSize, file.handle.size()));
+    }
+  };
+
+  // Reports failed files once nothing is reading into their buffers and
+  // closes finished ones.
+  auto retire = [&] {
+    std::erase_if(files, [&](const auto& f) {
+      if (f->inFlight > 0) {
+        return false;
+      }
+      if (f->error) {
+        fail(f->index, f->error);
+        return true;
+      }
+      return f->arrivedBlocks == f->blocksDone.size();
+    });
+  };
+
+  auto inFlight = [&] { return reads.size() - freeTags.size(); };
+  std::vector<ReadResult> results;
+  try {
+    fill();
+    while (inFlight() > 0 || nextPath < paths.size()) {
+      if (inFlight() == 0) {
+        // Every file opened so far was empty or failed to open.
+        fill();
+        continue;
+      }
+      results.clear();
+      queue->wait(results);
+      for (const auto& result : results) {
+        complete(result);
+      }
+      retire();
+      fill();
+    }
+  } catch (...) {
+    // The buffers may be freed once this returns, so let the reads writing
+    // into them finish first.
+    while (inFlight() > 0) {
+      results.clear();
+      queue->wait(results);
+      for (const auto& result : results) {
+        freeTags.emplace_back(result.tag);
+      }
+    }
+    throw;
+  }
+}
+
+}  // namespace MidiParser
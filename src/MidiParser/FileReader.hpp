@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <span>
+#include <string>
+
+namespace MidiParser {
+
+/**
+ * Settings controlling how a `MidiParser::FileReader` reads files.
+ */
+struct FileReaderOptions {
+
+  /**
+   * The most reads kept in flight at once, across all files.
+   */
+  size_t queueDepth = 64;
+
+  /**
+   * Files are read in blocks of this many bytes, so the start of a large
+   * file arrives, and can be decoded, before its end.
+   */
+  size_t blockSize = size_t{128} << 10;
+
+  /**
+   * The most files being read at once. Each of them holds a buffer of its
+   * full size.
+   */
+  size_t maxOpenFiles = 64;
+
+  /**
+   * Read through io_uring where the kernel supports it. Otherwise, or if
+   * this is `false`, blocking reads are spread over `ioThreads` threads.
+   */
+  bool useIoUring = true;
+
+  size_t ioThreads = 8;
+};
+
+/**
+ * Reads many files into memory with many reads in flight at once, reporting
+ * how much of each file has arrived as the reads complete. On Linux it
+ * submits the reads through io_uring, talking to the kernel directly, and
+ * falls back to `pread` calls on a few threads of its own where io_uring is
+ * unavailable, e.g. in containers that block it.
+ *
+ * Used by `MidiParser::Parser::parseMany` to decode tracks while the rest of
+ * the files are still being read.
+ */
+class FileReader {
+ public:
+  enum class Backend : uint8_t { IO_URING, THREADS };
+
+  /**
+   * Called once the size of file `index` is known. Returns the buffer of
+   * `size` bytes to read the file into, which must stay alive until the file
+   * is reported complete or failed. If it throws, the file is reported
+   * failed with the exception.
+   */
+  using OpenCallback =
+      std::function<std::span<std::byte>(size_t index, size_t size)>;
+
+  /**
+   * Called whenever the number of bytes at the start of file `index` that
+   * have arrived grows. The last call for a file has `bytes` equal to its
+   * size, after which its buffer is no longer touched.
+   */
+  using ProgressCallback = std::function<void(size_t index, size_t bytes)>;
+
+  /**
+   * Called instead of the last progress callback if file `index` cannot be
+   * opened or read. Its buffer, if any, is no longer touched.
+   */
+  using FailCallback =
+      std::function<void(size_t index, std::exception_ptr error)>;
+
+  /**
+   * Creates a reader, checking whether io_uring can be used if the options
+   * ask for it.
+   */
+  explicit FileReader(const FileReaderOptions& options = {});
+
+  /**
+   * The way reads are issued, decided when the reader is created.
+   */
+  Backend backend() const { return m_backend; }
+
+  /**
+   * Reads every file in `paths`, opening them in order. All callbacks run on
+   * the calling thread, which returns once every file has been reported
+   * complete or failed. Exceptions thrown by the callbacks propagate after
+   * the reads in flight have finished.
+   */
+  void read(std::span<const std::string> paths, const OpenCallback& open,
+            const ProgressCallback& progress, const FailCallback& fail) const;
+
+ private:
+  FileReaderOptions m_options;
+  Backend m_backend;
+};
+
+}  // namespace MidiParser
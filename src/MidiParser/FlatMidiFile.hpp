@@ -0,0 +1,65 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "FlatTrack.hpp"
+#include "NoteTable.hpp"
+#include "ParseError.hpp"
+#include "TempoMap.hpp"
+
+namespace MidiParser {
+
+/**
+ * The counterpart of `MidiParser::MidiFile` that stores its tracks as
+ * `MidiParser::FlatTrack`s. Used as the output of
+ * MidiParser::Parser::parseFlat.
+ */
+struct FlatMidiFile {
+
+  /**
+   * The format of a MIDI file. See `MidiParser::MidiFile::fileFormat`.
+   */
+  uint16_t fileFormat;
+
+  /**
+   * The number of track chunks to be found as declared in the header chunk.
+   */
+  uint16_t numTracks;
+
+  /**
+   * Unit of time used in the delta times. See
+   * `MidiParser::MidiFile::tickDivision`.
+   */
+  uint16_t tickDivision;
+
+  /**
+   * A vector containing parsed FlatTracks, the size of which should match
+   * `FlatMidiFile.numTracks`.
+   */
+  std::vector<FlatTrack> tracks;
+
+  /**
+   * The tempo map shared by all tracks, built from the `SET_TEMPO` events of
+   * every track. Only present when parsing with `ParseOptions::buildTimeIndex`,
+   * and never for format 2 files, whose tracks are independent sequences with
+   * tempos of their own.
+   */
+  std::optional<TempoMap> tempoMap;
+
+  /**
+   * The notes of all tracks ordered by start tick. Only present when parsing
+   * with `ParseOptions::pairNotes`.
+   */
+  std::optional<NoteTable> notes;
+
+  /**
+   * The errors that cut tracks short when parsing with
+   * `ParseOptions::lenient`, at most one per track, ordered by track.
+   */
+  std::vector<ParseError> errors;
+
+  bool operator==(const FlatMidiFile&) const = default;
+};
+
+}  // namespace MidiParser
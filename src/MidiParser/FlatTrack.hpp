@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <ranges>
+#include <vector>
+
+#include "NoteTable.hpp"
+#include "events.hpp"
+
+namespace MidiParser {
+
+/**
+ * A fixed-size, 16 byte record of one event inside a `MidiParser::FlatTrack`.
+ * The data of MIDI events is stored inline, while the data of meta and SysEx
+ * events lives in the track's payload arena.
+ */
+struct FlatEvent {
+  uint32_t deltaTime;
+  EventKind kind;
+
+  /**
+   * Same meaning as `MidiParser::EventView::status`.
+   */
+  uint8_t status;
+
+  /**
+   * The data bytes of a MIDI event. Unused for meta and SysEx events.
+   */
+  std::array<uint8_t, 2> inlineData;
+
+  /**
+   * The position of a meta or SysEx event's data in `FlatTrack::payload`.
+   * Always `0` for MIDI events.
+   */
+  uint32_t payloadOffset;
+
+  /**
+   * The number of data bytes, whether they are stored inline or in the
+   * payload arena.
+   */
+  uint32_t size;
+
+  bool operator==(const FlatEvent&) const = default;
+};
+
+static_assert(sizeof(FlatEvent) == 16);
+
+/**
+ * A compact alternative to `MidiParser::MidiTrack`. Events are stored in a
+ * single array of `MidiParser::FlatEvent` and the data of all meta and SysEx
+ * events shares one byte arena, so parsing a track performs a handful of
+ * allocations instead of one per event. Those allocations come from a
+ * `std::pmr::memory_resource`, see `ParseOptions::memoryResource`.
+ *
+ * Events are read through `MidiParser::EventView`s:
+ *
+ * `for (MidiParser::EventView e : track.views()) { ... }`
+ */
+struct FlatTrack {
+
+  /**
+   * The length of the track chunk in bytes as declared after the `MTrk`
+   * identifier.
+   */
+  uint32_t length;
+
+  /**
+   * Contains all events in this MIDI track.
+   */
+  std::pmr::vector<FlatEvent> events;
+
+  /**
+   * The concatenated data of all meta and SysEx events in this track.
+   */
+  std::pmr::vector<uint8_t> payload;
+
+  /**
+   * The absolute time of each event in ticks, parallel to `events`. Only
+   * filled in when parsing with `ParseOptions::buildTimeIndex`.
+   */
+  std::pmr::vector<uint64_t> absoluteTicks;
+
+  /**
+   * The notes of this track. Only filled in when parsing with
+   * `ParseOptions::pairNotes`, and not allocated from the memory resource.
+   */
+  NoteTable notes;
+
+  /**
+   * Returns the index of the first event at or after absolute tick `tick`,
+   * or the number of events if there is none. Requires `absoluteTicks`.
+   */
+  size_t seek(uint64_t tick) const {
+    return std::ranges::lower_bound(absoluteTicks, tick) -
+           absoluteTicks.begin();
+  }
+
+  /**
+   * Returns a view of `e`, which must be an element of `events`.
+   */
+  EventView view(const FlatEvent& e) const {
+    if (e.kind == EventKind::MIDI) {
+      return EventView{e.deltaTime, e.kind, e.status,
+                       {e.inlineData.data(), e.size}};
+    }
+    return EventView{e.deltaTime, e.kind, e.status,
+                     {payload.data() + e.payloadOffset, e.size}};
+  }
+
+  /**
+   * Returns a view of the event at `index`.
+   */
+  EventView view(size_t index) const { return view(events.at(index)); }
+
+  /**
+   * Returns a range of `MidiParser::EventView`s over all events.
+   */
+  auto views() const {
+    return events | std::views::transform(
+                        [this](const FlatEvent& e) { return view(e); });
+  }
+
+  /**
+   * Appends a copy of the event viewed by `e`.
+   */
+  void append(const EventView& e) {
+    FlatEvent flat{.deltaTime = e.deltaTime,
+                   .kind = e.kind,
+                   .status = e.status,
+                   .inlineData = {},
+                   .payloadOffset = 0,
+                   .size = static_cast<uint32_t>(e.data.size())};
+    if (e.kind == EventKind::MIDI) {
+      flat.size = std::min<uint32_t>(flat.size, flat.inlineData.size());
+      std::copy_n(e.data.begin(), flat.size, flat.inlineData.begin());
+    } else {
+      flat.payloadOffset = static_cast<uint32_t>(payload.size());
+      payload.insert(payload.end(), e.data.begin(), e.data.end());
+    }
+    events.emplace_back(flat);
+  }
+
+  bool operator==(const FlatTrack&) const = default;
+};
+
+}  // namespace MidiParser
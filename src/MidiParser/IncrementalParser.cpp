@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "IncrementalParser.hpp"
+#include "chunks.hpp"
+#include "read.hpp"
+
+namespace MidiParser {
+
+IncrementalParser::IncrementalParser(const ParseOptions& options)
+    : m_options(options) {}
+
+size_t IncrementalParser::update(std::span<const std::byte> bytes) {
+  std::span<const uint8_t> data(reinterpret_cast<const uint8_t*>(bytes.data()),
+                                bytes.size());
+  if (data.size() < m_size) {
+    throw std::invalid_argument("Data is shorter than in the last update.");
+  }
+  m_size = data.size();
+  if (m_tracks.empty() && !m_nextChunk) {
+    if (data.size() < HEADER_SIZE) {
+      return 0;
+    }
+    Header header = readHeader(data);
+    m_file.fileFormat = header.fileFormat;
+    m_file.numTracks = header.numTracks;
+    m_file.tickDivision = header.tickDivision;
+    m_nextChunk = HEADER_SIZE;
+  }
+
+  size_t added = 0;
+  bool tempoChanged = m_options.buildTimeIndex && !m_file.tempoMap;
+  auto decode = [&](size_t i) {
+    size_t tempos = m_tracks[i].tempos.size();
+    added += decodeTrack(data, i);
+    tempoChanged |= m_tracks[i].tempos.size() != tempos;
+  };
+  // Only the last track can still be open. It is also revisited after
+  // reaching a limit, to find where it ends.
+  for (size_t i = 0; i < m_tracks.size(); ++i) {
+    if (!m_tracks[i].finished || (i + 1 == m_tracks.size() && !m_nextChunk)) {
+      decode(i);
+    }
+  }
+  // Tracks are found one after another, and the chunk following an open
+  // track cannot be located before it closes.
+  while (m_nextChunk && m_tracks.size() < m_file.numTracks &&
+         data.size() - *m_nextChunk >= CHUNK_PREFIX_SIZE) {
+    m_tracks.emplace_back(TrackState{.dataOffset =
+                                         *m_nextChunk + CHUNK_PREFIX_SIZE});
+    m_file.tracks.emplace_back();
+    m_nextChunk.reset();
+    decode(m_tracks.size() - 1);
+  }
+
+  // Format 2 tracks are independent sequences and share no tempo map.
+  if (tempoChanged && m_file.fileFormat != 2) {
+    std::vector<TempoChange> merged;
+    for (const auto& t : m_tracks) {
+      merged.insert(merged.end(), t.tempos.begin(), t.tempos.end());
+    }
+    std::ranges::stable_sort(merged, {}, &TempoChange::tick);
+    m_file.tempoMap.emplace(m_file.tickDivision, merged);
+  }
+  return added;
+}
+
+size_t IncrementalParser::update(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    throw std::ios_base::failure("Unable to open file.");
+  }
+  auto size = static_cast<size_t>(file.tellg());
+  if (size < m_fileData.size()) {
+    reset();
+  }
+  size_t read = m_fileData.size();
+  m_fileData.resize(size);
+  file.seekg(static_cast<std::streamoff>(read));
+  file.read(reinterpret_cast<char*>(m_fileData.data() + read),
+            static_cast<std::streamsize>(size - read));
+  return update(std::as_bytes(std::span(m_fileData)));
+}
+
+bool IncrementalParser::complete() const {
+  return m_tracks.size() == m_file.numTracks &&
+         std::ranges::all_of(m_tracks, &TrackState::finished);
+}
+
+void IncrementalParser::reset() {
+  m_file = MidiFile{};
+  m_tracks.clear();
+  m_nextChunk.reset();
+  m_size = 0;
+  m_fileData.clear();
+}
+
+size_t IncrementalParser::decodeTrack(std::span<const uint8_t> data,
+                                      size_t index) {
+  TrackState& state = m_tracks[index];
+  MidiTrack& track = m_file.tracks[index];
+  // The length is read again every time, as a recorder may fill it in later.
+  uint32_t length = readUint32(&data[state.dataOffset - 4]);
+  bool open = length == 0 || data.size() - state.dataOffset < length;
+  const uint8_t* begin = data.data() + state.dataOffset;
+  const uint8_t* end = open ? data.data() + data.size() : begin + length;
+  const uint8_t* it = begin + state.decoded;
+
+  size_t added = 0;
+  state.finished |= state.kept >= m_options.maxEventsPerTrack;
+  // Once a limit is reached, the events of an open track are still stepped
+  // over, as its End of Track event is the only way to find the next track.
+  while (!state.ended && (open || !state.finished) && it != end) {
+    auto e = readCompleteEvent(it, end, state.runningStatus);
+    if (!e) {
+      break;
+    }
+    state.decoded = static_cast<size_t>(it - begin);
+    state.ended = e->kind == EventKind::META &&
+                  e->status == static_cast<uint8_t>(Meta::END_OF_TRACK);
+    if (state.finished) {
+      continue;
+    }
+    state.tick += e->deltaTime;
+    if (state.tick > m_options.maxTick) {
+      state.finished = true;
+      continue;
+    }
+    if (m_options.buildTimeIndex && e->kind == EventKind::META &&
+        e->status == static_cast<uint8_t>(Meta::SET_TEMPO) &&
+        e->data.size() == 3) {
+      state.tempos.emplace_back(
+          state.tick, static_cast<uint32_t>(e->data[0] << 16 |
+                                            e->data[1] << 8 | e->data[2]));
+    }
+    if (m_options.filter.accepts(*e)) {
+      e->deltaTime = static_cast<uint32_t>(state.tick - state.lastKept);
+      state.lastKept = state.tick;
+      track.events.emplace_back(toTrackEvent(*e));
+      if (m_options.buildTimeIndex) {
+        track.absoluteTicks.emplace_back(state.tick);
+      }
+      ++state.kept;
+      ++added;
+    }
+    state.finished = state.ended || state.kept >= m_options.maxEventsPerTrack;
+  }
+  track.length = open ? static_cast<uint32_t>(state.decoded) : length;
+
+  if (!open) {
+    if (state.ended && it != end) {
+      throw std::runtime_error(
+          "Track was marked as finished before reaching the end of the "
+          "iterator.");
+    }
+    if (!state.finished) {
+      throw std::runtime_error(
+          it == end ? "Track ended before an End of Track event was found."
+                    : "Event data extends past the end of the track.");
+    }
+    m_nextChunk = state.dataOffset + length;
+  } else if (state.ended) {
+    m_nextChunk = state.dataOffset + state.decoded;
+  }
+  return added;
+}
+
+}  // namespace MidiParser
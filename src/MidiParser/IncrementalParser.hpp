@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "MidiFile.hpp"
+#include "ParseOptions.hpp"
+#include "TempoMap.hpp"
+
+namespace MidiParser {
+
+/**
+ * Parses a MIDI file that is still growing, such as a recording in progress,
+ * decoding only the bytes appended since the last call.
+ *
+ * The decode state of every track (byte offset, running status and
+ * absolute tick) is kept between calls to `update`, and new events are
+ * appended to the tracks of `file`. A track whose declared length runs past
+ * the end of the data, or is still `0` as some recorders leave it until they
+ * close the file, is open: it extends to the end of the data and an event cut
+ * off there is decoded once the rest of it arrives. Bytes following the last
+ * track are not an error.
+ *
+ * Example usage:
+ *
+ * `MidiParser::IncrementalParser parser;`
+ * `while (recording) {`
+ * `  parser.update("path/to/recording.mid");`
+ * `  const MidiParser::MidiFile& f = parser.file();`
+ * `}`
+ *
+ * Of the options, `filter`, `maxEventsPerTrack`, `maxTick` and
+ * `buildTimeIndex` apply. Tracks are decoded on the calling thread.
+ */
+class IncrementalParser {
+ public:
+  explicit IncrementalParser(const ParseOptions& options = {});
+
+  /**
+   * Decodes the part of `data` not seen by earlier calls, returning the
+   * number of events added to `file`. `data` holds the whole file so far and
+   * must start with the bytes passed before. Throws `std::invalid_argument`
+   * if `data` is shorter than before and `std::runtime_error` if it is not a
+   * valid MIDI file, after which the parser must be `reset`.
+   */
+  size_t update(std::span<const std::byte> data);
+
+  /**
+   * Reads the bytes appended to the file located at `path` since the last
+   * call and decodes them like the in-memory overload. Starts over if the
+   * file got shorter. Throws `std::ios_base::failure` if the file cannot be
+   * read.
+   */
+  size_t update(const std::string& path);
+
+  /**
+   * The file as decoded so far. `numTracks` is the number the header
+   * declares; `tracks` only holds those found yet.
+   */
+  const MidiFile& file() const { return m_file; }
+
+  /**
+   * Whether every declared track has been decoded up to its End of Track
+   * event, or up to the options' event or tick limit.
+   */
+  bool complete() const;
+
+  /**
+   * Forgets everything decoded so far.
+   */
+  void reset();
+
+ private:
+  /**
+   * Where decoding a track stopped.
+   */
+  struct TrackState {
+    /**
+     * The offset of the track chunk's data in the file.
+     */
+    size_t dataOffset;
+
+    /**
+     * The number of bytes of the track chunk's data decoded so far.
+     */
+    size_t decoded = 0;
+
+    uint8_t runningStatus = 0;
+    uint64_t tick = 0;
+
+    /**
+     * The absolute tick of the last kept event, which the next kept event's
+     * delta time is relative to.
+     */
+    uint64_t lastKept = 0;
+    size_t kept = 0;
+
+    /**
+     * Set once the End of Track event or a limit has been reached.
+     */
+    bool finished = false;
+
+    /**
+     * Set once the End of Track event has been read, which for an open track
+     * may be well after a limit was reached.
+     */
+    bool ended = false;
+
+    std::vector<TempoChange> tempos;
+  };
+
+  ParseOptions m_options;
+  MidiFile m_file{};
+  std::vector<TrackState> m_tracks;
+
+  /**
+   * Where the next track chunk starts, once the header has been read.
+   */
+  std::optional<size_t> m_nextChunk;
+
+  /**
+   * The size of the data passed to the last `update`.
+   */
+  size_t m_size = 0;
+
+  /**
+   * What `update(path)` has read of the file so far.
+   */
+  std::vector<uint8_t> m_fileData;
+
+  size_t decodeTrack(std::span<const uint8_t> data, size_t index);
+};
+
+}  // namespace MidiParser
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace MidiParser {
+
+/**
+ * A read-only memory mapping of a file. The mapped bytes stay valid for as
+ * long as the `MappedFile` is alive.
+ *
+ * Example usage:
+ *
+ * `MidiParser::MappedFile file("path/to/file.mid");`
+ * `std::span<const std::byte> bytes = file.bytes();`
+ */
+class MappedFile {
+ public:
+  /**
+   * Maps the file located at `path`. Throws `std::ios_base::failure` if the
+   * file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  /**
+   * The contents of the mapped file. Empty if the file is empty.
+   */
+  std::span<const std::byte> bytes() const { return {m_data, m_size}; }
+
+ private:
+  const std::byte* m_data = nullptr;
+  size_t m_size = 0;
+
+#ifdef _WIN32
+  void* m_file = nullptr;
+  void* m_mapping = nullptr;
+#endif
+
+  void unmap() noexcept;
+};
+
+}  // namespace MidiParser
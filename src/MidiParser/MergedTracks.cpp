@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <variant>
+
+#include "MergedTracks.hpp"
+#include "Writer.hpp"
+
+namespace MidiParser {
+
+namespace {
+
+uint32_t deltaTimeOf(const TrackEvent& e) {
+  return std::visit([](const auto& v) { return v.deltaTime; }, e);
+}
+
+/**
+ * Orders the cursor heap so the earliest event, and of simultaneous events
+ * the one from the lowest track, is on top.
+ */
+template <typename Cursor>
+bool later(const Cursor& a, const Cursor& b) {
+  return a.tick != b.tick ? a.tick > b.tick : a.track > b.track;
+}
+
+bool isEndOfTrack(const TrackEvent& e) {
+  const auto* meta = std::get_if<MetaEvent>(&e);
+  return meta && meta->status == static_cast<uint8_t>(Meta::END_OF_TRACK);
+}
+
+}  // namespace
+
+MergedTracks::MergedTracks(const MidiFile& file) : m_file(&file) {
+  m_heap.reserve(file.tracks.size());
+  for (size_t i = 0; i < file.tracks.size(); ++i) {
+    const auto& events = file.tracks[i].events;
+    if (!events.empty()) {
+      m_heap.emplace_back(deltaTimeOf(events.front()), i, 0);
+    }
+  }
+  std::ranges::make_heap(m_heap, later<Cursor>);
+}
+
+std::optional<MergedEvent> MergedTracks::next() {
+  if (m_heap.empty()) {
+    return std::nullopt;
+  }
+  std::ranges::pop_heap(m_heap, later<Cursor>);
+  Cursor& c = m_heap.back();
+  const auto& events = m_file->tracks[c.track].events;
+  MergedEvent e{c.tick, c.track, &events[c.index]};
+  if (++c.index < events.size()) {
+    c.tick += deltaTimeOf(events[c.index]);
+    std::ranges::push_heap(m_heap, later<Cursor>);
+  } else {
+    m_heap.pop_back();
+  }
+  return e;
+}
+
+MidiFile flattenToFormat0(const MidiFile& file) {
+  size_t numEvents = 0;
+  for (const auto& t : file.tracks) {
+    numEvents += t.events.size();
+  }
+  MidiTrack track{.length = 0, .events = {}, .absoluteTicks = {}};
+  track.events.reserve(numEvents + 1);
+  // Keep the time index if the source file has one.
+  bool indexed = file.tempoMap.has_value();
+  if (indexed) {
+    track.absoluteTicks.reserve(numEvents + 1);
+  }
+  uint64_t lastTick = 0;
+  uint64_t endTick = 0;
+  for (MergedEvent e : MergedTracks(file)) {
+    endTick = std::max(endTick, e.tick);
+    if (isEndOfTrack(*e.event)) {
+      continue;
+    }
+    TrackEvent& copy = track.events.emplace_back(*e.event);
+    auto deltaTime = static_cast<uint32_t>(e.tick - lastTick);
+    std::visit([&](auto& v) { v.deltaTime = deltaTime; }, copy);
+    lastTick = e.tick;
+    if (indexed) {
+      track.absoluteTicks.emplace_back(e.tick);
+    }
+  }
+  track.events.emplace_back(
+      MetaEvent{.deltaTime = static_cast<uint32_t>(endTick - lastTick),
+                .status = static_cast<uint8_t>(Meta::END_OF_TRACK),
+                .data = {}});
+  if (indexed) {
+    track.absoluteTicks.emplace_back(endTick);
+  }
+  track.length = static_cast<uint32_t>(encodedSize(track));
+  return MidiFile{.fileFormat = 0,
+                  .numTracks = 1,
+                  .tickDivision = file.tickDivision,
+                  .tracks = {std::move(track)},
+                  .tempoMap = file.tempoMap};
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include "MidiFile.hpp"
+
+namespace MidiParser {
+
+/**
+ * An event of a `MidiParser::MidiFile` together with its position in time and
+ * the track it belongs to.
+ */
+struct MergedEvent {
+  /**
+   * The absolute time of the event in ticks.
+   */
+  uint64_t tick;
+
+  /**
+   * The index of the event's track in `MidiFile::tracks`.
+   */
+  size_t track;
+
+  /**
+   * The event itself, which points into the merged file.
+   */
+  const TrackEvent* event;
+};
+
+/**
+ * Interleaves the tracks of a `MidiParser::MidiFile` into a single stream of
+ * events ordered by absolute time. Events at the same tick are returned in
+ * track order, and events of one track keep their order.
+ *
+ * The merge is lazy: a heap holds one cursor per track, so the view allocates
+ * once and each event costs `O(log k)` for `k` tracks.
+ *
+ * Example usage:
+ *
+ * `for (MidiParser::MergedEvent e : MidiParser::MergedTracks(file)) { ... }`
+ */
+class MergedTracks {
+ public:
+  /**
+   * Creates a view over the tracks of `file`, which must outlive the view and
+   * the events it returns.
+   */
+  explicit MergedTracks(const MidiFile& file);
+
+  /**
+   * Returns the next event in time order, or `std::nullopt` once the events
+   * of every track have been returned.
+   */
+  std::optional<MergedEvent> next();
+
+  /**
+   * Whether every event has been returned.
+   */
+  bool done() const { return m_heap.empty(); }
+
+  class iterator {
+   public:
+    using value_type = MergedEvent;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    explicit iterator(MergedTracks* merged) : m_merged(merged) { ++*this; }
+
+    const MergedEvent& operator*() const { return m_current; }
+    const MergedEvent* operator->() const { return &m_current; }
+
+    iterator& operator++() {
+      if (auto e = m_merged->next()) {
+        m_current = *e;
+      } else {
+        m_merged = nullptr;
+      }
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    bool operator==(std::default_sentinel_t) const {
+      return m_merged == nullptr;
+    }
+
+   private:
+    MergedTracks* m_merged = nullptr;
+    MergedEvent m_current{};
+  };
+
+  /**
+   * Returns an iterator to the first event not yet returned.
+   */
+  iterator begin() { return iterator(this); }
+  std::default_sentinel_t end() { return {}; }
+
+ private:
+  /**
+   * The next unreturned event of one track.
+   */
+  struct Cursor {
+    uint64_t tick;
+    size_t track;
+    size_t index;
+  };
+
+  const MidiFile* m_file;
+  std::vector<Cursor> m_heap;
+};
+
+/**
+ * Merges the tracks of `file` into the single track of an equivalent format 0
+ * file. Every event keeps its absolute time; the End of Track events of the
+ * source tracks are replaced by one at the time the last track ends. The
+ * track's `length` is its size as `MidiParser::Writer` writes it by default.
+ */
+MidiFile flattenToFormat0(const MidiFile& file);
+
+}  // namespace MidiParser
@@ -0,0 +1,298 @@
+#include <array>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "MidiCache.hpp"
+
+namespace MidiParser {
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC = {'M', 'I', 'D', 'I', 'C', 'A', 'C', 'H'};
+
+/**
+ * Written in the byte order of the machine writing the cache, so a reader
+ * of the other byte order sees it reversed.
+ */
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/**
+ * Set in `CacheHeader::flags` if every track has absolute ticks.
+ */
+constexpr uint32_t HAS_TIME_INDEX = 1;
+
+/**
+ * Set in `CacheHeader::flags` if the tempo map is stored.
+ */
+constexpr uint32_t HAS_TEMPO_MAP = 2;
+
+/**
+ * Every section starts at a multiple of this, so tables can be used in
+ * place from a page aligned mapping.
+ */
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+/**
+ * The start of a cache. All offsets are from the start of the cache.
+ */
+struct CacheHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t sourceHash;
+  uint16_t fileFormat;
+  uint16_t numTracks;
+  uint16_t tickDivision;
+  uint16_t reserved;
+  uint32_t flags;
+  uint32_t trackCount;
+  uint64_t tempoOffset;
+  uint64_t tempoCount;
+};
+
+/**
+ * Where the tables of one track are. The `CacheHeader` is followed by one of
+ * these per track.
+ */
+struct TrackEntry {
+  uint32_t length;
+  uint32_t reserved;
+  uint64_t eventCount;
+  uint64_t eventsOffset;
+  uint64_t payloadSize;
+  uint64_t payloadOffset;
+
+  /**
+   * Holds `eventCount` ticks if the cache has a time index.
+   */
+  uint64_t ticksOffset;
+};
+
+static_assert(sizeof(CacheHeader) == 56);
+static_assert(sizeof(TrackEntry) == 48);
+static_assert(sizeof(TempoMap::Segment) == 24);
+
+uint64_t align(uint64_t offset) {
+  return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+/**
+ * The final mix of splitmix64, spreading every input bit over the result.
+ */
+uint64_t mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+uint64_t readLittleEndian(const std::byte* p, size_t size) {
+  uint64_t word = 0;
+  std::memcpy(&word, p, size);
+  if constexpr (std::endian::native == std::endian::big) {
+    word = std::byteswap(word);
+  }
+  return word;
+}
+
+/**
+ * Returns a span of `count` elements of type `T` at `offset` in `data`.
+ * Throws `std::runtime_error` if they do not fit or are misaligned.
+ */
+template <typename T>
+std::span<const T> table(std::span<const std::byte> data, uint64_t offset,
+                         uint64_t count) {
+  if (offset > data.size() || count > (data.size() - offset) / sizeof(T) ||
+      offset % alignof(T) != 0) {
+    throw std::runtime_error("Cache table lies outside of the cache.");
+  }
+  return {reinterpret_cast<const T*>(data.data() + offset),
+          static_cast<size_t>(count)};
+}
+
+/**
+ * Writes `bytes` bytes starting at `data` followed by zeros up to the next
+ * section, keeping track of the offset in `written`.
+ */
+void writeSection(std::ostream& out, const void* data, uint64_t bytes,
+                  uint64_t& written) {
+  static constexpr std::array<char, SECTION_ALIGNMENT> zeros{};
+  out.write(static_cast<const char*>(data),
+            static_cast<std::streamsize>(bytes));
+  written += bytes;
+  out.write(zeros.data(), static_cast<std::streamsize>(align(written) -
+                                                       written));
+  written = align(written);
+}
+
+}  // namespace
+
+uint64_t contentHash(std::span<const std::byte> data) {
+  constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87;
+  constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4F;
+  uint64_t hash = mix(data.size() + PRIME1);
+  size_t i = 0;
+  for (; data.size() - i >= 8; i += 8) {
+    hash = std::rotl(hash + readLittleEndian(&data[i], 8) * PRIME2, 31) *
+           PRIME1;
+  }
+  if (i != data.size()) {
+    hash ^= readLittleEndian(data.data() + i, data.size() - i) * PRIME2;
+  }
+  return mix(hash);
+}
+
+std::string cacheFileName(uint64_t sourceHash) {
+  return std::format("{:016x}.midicache", sourceHash);
+}
+
+void writeCache(const FlatMidiFile& file, uint64_t sourceHash,
+                std::ostream& out) {
+  bool timeIndex =
+      std::ranges::all_of(file.tracks, [](const FlatTrack& t) {
+        return t.absoluteTicks.size() == t.events.size();
+      }) &&
+      std::ranges::any_of(file.tracks, [](const FlatTrack& t) {
+        return !t.absoluteTicks.empty();
+      });
+  const std::vector<TempoMap::Segment>* segments =
+      file.tempoMap ? &file.tempoMap->segments() : nullptr;
+
+  CacheHeader header{
+      .magic = MAGIC,
+      .version = CACHE_VERSION,
+      .byteOrder = BYTE_ORDER_MARK,
+      .sourceHash = sourceHash,
+      .fileFormat = file.fileFormat,
+      .numTracks = file.numTracks,
+      .tickDivision = file.tickDivision,
+      .reserved = 0,
+      .flags = (timeIndex ? HAS_TIME_INDEX : 0) |
+               (segments ? HAS_TEMPO_MAP : 0),
+      .trackCount = static_cast<uint32_t>(file.tracks.size()),
+      .tempoOffset = 0,
+      .tempoCount = segments ? segments->size() : 0,
+  };
+  // Lay out all sections before writing anything, so the cache is written
+  // in a single pass.
+  uint64_t offset =
+      sizeof(CacheHeader) + sizeof(TrackEntry) * file.tracks.size();
+  header.tempoOffset = offset;
+  offset = align(offset + sizeof(TempoMap::Segment) * header.tempoCount);
+  std::vector<TrackEntry> entries;
+  entries.reserve(file.tracks.size());
+  for (const FlatTrack& t : file.tracks) {
+    TrackEntry& e = entries.emplace_back(TrackEntry{
+        .length = t.length,
+        .reserved = 0,
+        .eventCount = t.events.size(),
+        .eventsOffset = offset,
+        .payloadSize = t.payload.size(),
+        .payloadOffset = 0,
+        .ticksOffset = 0,
+    });
+    offset = align(offset + sizeof(FlatEvent) * e.eventCount);
+    e.payloadOffset = offset;
+    offset = align(offset + e.payloadSize);
+    e.ticksOffset = offset;
+    if (timeIndex) {
+      offset += sizeof(uint64_t) * e.eventCount;
+    }
+  }
+
+  uint64_t written = 0;
+  writeSection(out, &header, sizeof(header), written);
+  writeSection(out, entries.data(), sizeof(TrackEntry) * entries.size(),
+               written);
+  if (segments) {
+    writeSection(out, segments->data(),
+                 sizeof(TempoMap::Segment) * segments->size(), written);
+  }
+  for (const FlatTrack& t : file.tracks) {
+    writeSection(out, t.events.data(), sizeof(FlatEvent) * t.events.size(),
+                 written);
+    writeSection(out, t.payload.data(), t.payload.size(), written);
+    if (timeIndex) {
+      writeSection(out, t.absoluteTicks.data(),
+                   sizeof(uint64_t) * t.absoluteTicks.size(), written);
+    }
+  }
+}
+
+void writeCache(const FlatMidiFile& file, uint64_t sourceHash,
+                const std::string& path) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    throw std::ios_base::failure("Unable to open file.");
+  }
+  writeCache(file, sourceHash, out);
+  out.flush();
+  if (!out) {
+    throw std::ios_base::failure("Unable to write file.");
+  }
+}
+
+CachedMidiFile::CachedMidiFile(const std::string& path) : m_file(path) {
+  std::span<const std::byte> data = m_file.bytes();
+  CacheHeader header;
+  if (data.size() < sizeof(header)) {
+    throw std::runtime_error("File is too short to be a MIDI cache.");
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.magic != MAGIC) {
+    throw std::runtime_error("File is not a MIDI cache.");
+  }
+  if (header.byteOrder != BYTE_ORDER_MARK) {
+    throw std::runtime_error("MIDI cache was written in another byte order.");
+  }
+  if (header.version != CACHE_VERSION) {
+    throw std::runtime_error(
+        std::format("MIDI cache has version {} instead of {}.",
+                    header.version, CACHE_VERSION));
+  }
+  m_fileFormat = header.fileFormat;
+  m_numTracks = header.numTracks;
+  m_tickDivision = header.tickDivision;
+  m_sourceHash = header.sourceHash;
+
+  auto entries = table<TrackEntry>(data, sizeof(header), header.trackCount);
+  m_tracks.reserve(entries.size());
+  for (const TrackEntry& e : entries) {
+    m_tracks.emplace_back(CachedTrack{
+        .length = e.length,
+        .events = table<FlatEvent>(data, e.eventsOffset, e.eventCount),
+        .payload = table<uint8_t>(data, e.payloadOffset, e.payloadSize),
+        .absoluteTicks =
+            header.flags & HAS_TIME_INDEX
+                ? table<uint64_t>(data, e.ticksOffset, e.eventCount)
+                : std::span<const uint64_t>(),
+    });
+  }
+  if (header.flags & HAS_TEMPO_MAP) {
+    auto segments = table<TempoMap::Segment>(data, header.tempoOffset,
+                                             header.tempoCount);
+    m_tempoMap.emplace(
+        std::vector<TempoMap::Segment>(segments.begin(), segments.end()));
+  }
+}
+
+FlatMidiFile CachedMidiFile::toFlatMidiFile() const {
+  FlatMidiFile file{.fileFormat = m_fileFormat,
+                    .numTracks = m_numTracks,
+                    .tickDivision = m_tickDivision,
+                    .tracks = {},
+                    .tempoMap = m_tempoMap};
+  file.tracks.reserve(m_tracks.size());
+  for (const CachedTrack& t : m_tracks) {
+    FlatTrack& copy = file.tracks.emplace_back();
+    copy.length = t.length;
+    copy.events.assign(t.events.begin(), t.events.end());
+    copy.payload.assign(t.payload.begin(), t.payload.end());
+    copy.absoluteTicks.assign(t.absoluteTicks.begin(), t.absoluteTicks.end());
+  }
+  return file;
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "FlatMidiFile.hpp"
+#include "FlatTrack.hpp"
+#include "MappedFile.hpp"
+#include "TempoMap.hpp"
+#include "events.hpp"
+
+namespace MidiParser {
+
+/**
+ * The version of the cache format written by `MidiParser::writeCache`. Caches
+ * of any other version are rejected when loaded.
+ */
+constexpr uint32_t CACHE_VERSION = 1;
+
+/**
+ * A 64 bit hash of the bytes of a MIDI file, used to key its cache. It is fast
+ * rather than cryptographic, so it must not be relied on to tell apart files
+ * crafted to collide.
+ */
+uint64_t contentHash(std::span<const std::byte> data);
+
+/**
+ * The name of the cache file of a MIDI file whose `contentHash` is
+ * `sourceHash`: the hash as 16 hex digits followed by `.midicache`.
+ */
+std::string cacheFileName(uint64_t sourceHash);
+
+/**
+ * Writes `file` to `out` in the cache format read by
+ * `MidiParser::CachedMidiFile`, recording `sourceHash` as the hash of the MIDI
+ * file it was parsed from. Absolute ticks and the tempo map are stored if
+ * `file` has them.
+ *
+ * The cache holds the events as parsed, so it reflects the
+ * `MidiParser::ParseOptions` that produced `file`. It uses the byte order of
+ * the machine writing it and is only read back on machines sharing it.
+ */
+void writeCache(const FlatMidiFile& file, uint64_t sourceHash,
+                std::ostream& out);
+
+/**
+ * Writes the cache of `file` to `path` like the stream overload. Throws
+ * `std::ios_base::failure` if the file cannot be written.
+ */
+void writeCache(const FlatMidiFile& file, uint64_t sourceHash,
+                const std::string& path);
+
+/**
+ * A track of a `MidiParser::CachedMidiFile`. It has the same layout as a
+ * `MidiParser::FlatTrack`, but its arrays point into the mapped cache.
+ */
+struct CachedTrack {
+
+  /**
+   * The length of the track chunk in bytes as declared after the `MTrk`
+   * identifier.
+   */
+  uint32_t length;
+
+  std::span<const FlatEvent> events;
+  std::span<const uint8_t> payload;
+
+  /**
+   * Empty unless the cache was written from a file parsed with
+   * `ParseOptions::buildTimeIndex`.
+   */
+  std::span<const uint64_t> absoluteTicks;
+
+  /**
+   * See `MidiParser::FlatTrack::seek`.
+   */
+  size_t seek(uint64_t tick) const {
+    return std::ranges::lower_bound(absoluteTicks, tick) -
+           absoluteTicks.begin();
+  }
+
+  /**
+   * Returns a view of `e`, which must be an element of `events`.
+   */
+  EventView view(const FlatEvent& e) const {
+    if (e.kind == EventKind::MIDI) {
+      return EventView{e.deltaTime, e.kind, e.status,
+                       {e.inlineData.data(), e.size}};
+    }
+    return EventView{e.deltaTime, e.kind, e.status,
+                     {payload.data() + e.payloadOffset, e.size}};
+  }
+
+  /**
+   * Returns a view of the event at `index`.
+   */
+  EventView view(size_t index) const { return view(events[index]); }
+
+  /**
+   * Returns a range of `MidiParser::EventView`s over all events.
+   */
+  auto views() const {
+    return events | std::views::transform(
+                        [this](const FlatEvent& e) { return view(e); });
+  }
+};
+
+/**
+ * A parsed MIDI file loaded from a cache written by `MidiParser::writeCache`.
+ *
+ * The cache is memory-mapped and its event tables are used in place, so
+ * loading it only checks the header and the bounds of each table, no matter
+ * how many events it holds. Pages are read in by the system as they are
+ * first touched.
+ *
+ * Example usage:
+ *
+ * `MidiParser::CachedMidiFile f(dir + "/" + cacheFileName(hash));`
+ * `for (MidiParser::EventView e : f.tracks()[0].views()) { ... }`
+ *
+ * The events are trusted to be those `writeCache` wrote. A cache that was
+ * altered afterwards can lead to reads outside of its payload.
+ */
+class CachedMidiFile {
+ public:
+  /**
+   * Maps the cache located at `path`. Throws `std::ios_base::failure` if the
+   * file cannot be mapped and `std::runtime_error` if it is not a cache of
+   * version `CACHE_VERSION` written on a machine of the same byte order.
+   */
+  explicit CachedMidiFile(const std::string& path);
+
+  /**
+   * See `MidiParser::MidiFile::fileFormat`.
+   */
+  uint16_t fileFormat() const { return m_fileFormat; }
+
+  /**
+   * See `MidiParser::MidiFile::numTracks`.
+   */
+  uint16_t numTracks() const { return m_numTracks; }
+
+  /**
+   * See `MidiParser::MidiFile::tickDivision`.
+   */
+  uint16_t tickDivision() const { return m_tickDivision; }
+
+  /**
+   * The hash of the MIDI file the cache was written from.
+   */
+  uint64_t sourceHash() const { return m_sourceHash; }
+
+  const std::vector<CachedTrack>& tracks() const { return m_tracks; }
+
+  /**
+   * Present if the cache was written from a file parsed with
+   * `ParseOptions::buildTimeIndex`.
+   */
+  const std::optional<TempoMap>& tempoMap() const { return m_tempoMap; }
+
+  /**
+   * Copies the cached file into a `MidiParser::FlatMidiFile` that no longer
+   * depends on the mapping.
+   */
+  FlatMidiFile toFlatMidiFile() const;
+
+ private:
+  MappedFile m_file;
+  uint16_t m_fileFormat;
+  uint16_t m_numTracks;
+  uint16_t m_tickDivision;
+  uint64_t m_sourceHash;
+  std::vector<CachedTrack> m_tracks;
+  std::optional<TempoMap> m_tempoMap;
+};
+
+}  // namespace MidiParser
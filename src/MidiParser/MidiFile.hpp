@@ -1,8 +1,12 @@
 #pragma once
 
+#include <optional>
 #include <vector>
 
 #include "MidiTrack.hpp"
+#include "NoteTable.hpp"
+#include "ParseError.hpp"
+#include "TempoMap.hpp"
 
 namespace MidiParser {
 
@@ -37,6 +41,28 @@ struct MidiFile {
    * `MidiFile.numTracks`.
    */
   std::vector<MidiTrack> tracks;
+
+  /**
+   * The tempo map shared by all tracks, built from the `SET_TEMPO` events of
+   * every track. Only present when parsing with `ParseOptions::buildTimeIndex`,
+   * and never for format 2 files, whose tracks are independent sequences with
+   * tempos of their own.
+   */
+  std::optional<TempoMap> tempoMap;
+
+  /**
+   * The notes of all tracks ordered by start tick. Only present when parsing
+   * with `ParseOptions::pairNotes`.
+   */
+  std::optional<NoteTable> notes;
+
+  /**
+   * The errors that cut tracks short when parsing with
+   * `ParseOptions::lenient`, at most one per track, ordered by track.
+   */
+  std::vector<ParseError> errors;
+
+  bool operator==(const MidiFile&) const = default;
 };
 
 }  // namespace MidiParser
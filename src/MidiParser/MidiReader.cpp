@@ -0,0 +1,32 @@
+#include "MidiReader.hpp"
+#include "chunks.hpp"
+
+namespace MidiParser {
+
+MidiReader::MidiReader(std::span<const std::byte> data)
+    : m_data(reinterpret_cast<const uint8_t*>(data.data()), data.size()) {
+  readHeaderData();
+}
+
+MidiReader::MidiReader(const std::string& path) : m_file(path) {
+  auto bytes = m_file->bytes();
+  m_data = {reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()};
+  readHeaderData();
+}
+
+std::optional<TrackReader> MidiReader::nextTrack() {
+  if (m_nextTrack == m_numTracks) {
+    return std::nullopt;
+  }
+  return TrackReader(readTrackChunk(m_data, m_offset, m_nextTrack++));
+}
+
+void MidiReader::readHeaderData() {
+  Header header = readHeader(m_data);
+  m_fileFormat = header.fileFormat;
+  m_numTracks = header.numTracks;
+  m_tickDivision = header.tickDivision;
+  m_offset = HEADER_SIZE;
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "MappedFile.hpp"
+#include "TrackReader.hpp"
+
+namespace MidiParser {
+
+/**
+ * A pull-based alternative to `MidiParser::Parser` that never materializes a
+ * track. Only the header chunk is read up front; tracks are located one at
+ * a time and their events are decoded on demand by a
+ * `MidiParser::TrackReader`.
+ *
+ * Example usage:
+ *
+ * `MidiParser::MidiReader reader("path/to/file.mid");`
+ * `while (auto track = reader.nextTrack()) {`
+ * `  for (MidiParser::EventView e : *track) { ... }`
+ * `}`
+ */
+class MidiReader {
+ public:
+  /**
+   * Reads from a MIDI file held in memory, which must outlive the reader.
+   * Throws `std::runtime_error` if `data` does not start with a header
+   * chunk.
+   */
+  explicit MidiReader(std::span<const std::byte> data);
+
+  /**
+   * Reads from the MIDI file located at `path`, which is memory-mapped for
+   * the lifetime of the reader. Throws `std::ios_base::failure` if the file
+   * cannot be mapped.
+   */
+  explicit MidiReader(const std::string& path);
+
+  uint16_t fileFormat() const { return m_fileFormat; }
+  uint16_t numTracks() const { return m_numTracks; }
+  uint16_t tickDivision() const { return m_tickDivision; }
+
+  /**
+   * Returns a reader over the next track chunk, or `std::nullopt` once all
+   * tracks declared in the header have been returned. Throws
+   * `std::runtime_error` if the chunk does not fit into the file.
+   */
+  std::optional<TrackReader> nextTrack();
+
+ private:
+  std::optional<MappedFile> m_file;
+  std::span<const uint8_t> m_data;
+  size_t m_offset = 0;
+  size_t m_nextTrack = 0;
+
+  uint16_t m_fileFormat;
+  uint16_t m_numTracks;
+  uint16_t m_tickDivision;
+
+  void readHeaderData();
+};
+
+}  // namespace MidiParser
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
+#include "NoteTable.hpp"
 #include "events.hpp"
 
 namespace MidiParser {
@@ -22,6 +26,29 @@ struct MidiTrack {
    * Contains all Events in this MIDI track.
    */
   std::vector<TrackEvent> events;
+
+  /**
+   * The absolute time of each event in ticks, parallel to `events`. Only
+   * filled in when parsing with `ParseOptions::buildTimeIndex`.
+   */
+  std::vector<uint64_t> absoluteTicks;
+
+  /**
+   * The notes of this track. Only filled in when parsing with
+   * `ParseOptions::pairNotes`.
+   */
+  NoteTable notes;
+
+  /**
+   * Returns the index of the first event at or after absolute tick `tick`,
+   * or the number of events if there is none. Requires `absoluteTicks`.
+   */
+  size_t seek(uint64_t tick) const {
+    return std::ranges::lower_bound(absoluteTicks, tick) -
+           absoluteTicks.begin();
+  }
+
+  bool operator==(const MidiTrack&) const = default;
 };
 
 }  // namespace MidiParser
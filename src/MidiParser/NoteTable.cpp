@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <utility>
+
+#include "NoteTable.hpp"
+
+namespace MidiParser {
+
+NotePairer::NotePairer(NoteTable& table, uint16_t track)
+    : m_table(&table), m_track(track), m_next(table.size(), NONE) {
+  m_first.fill(NONE);
+  m_last.fill(NONE);
+}
+
+void NotePairer::noteOn(uint64_t tick, uint8_t channel, uint8_t key,
+                        uint8_t velocity) {
+  auto index = static_cast<uint32_t>(m_table->size());
+  m_table->append(tick, 0, key, velocity, channel, m_track);
+  m_next.emplace_back(NONE);
+  size_t queue = channel * 128u + (key & 0x7F);
+  if (m_last[queue] == NONE) {
+    m_first[queue] = index;
+  } else {
+    m_next[m_last[queue]] = index;
+  }
+  m_last[queue] = index;
+}
+
+void NotePairer::noteOff(uint64_t tick, uint8_t channel, uint8_t key) {
+  size_t queue = channel * 128u + (key & 0x7F);
+  uint32_t index = m_first[queue];
+  if (index == NONE) {
+    ++m_table->danglingNoteOffs;
+    return;
+  }
+  m_table->duration[index] = tick - m_table->start[index];
+  m_first[queue] = m_next[index];
+  if (m_first[queue] == NONE) {
+    m_last[queue] = NONE;
+  }
+}
+
+void NotePairer::finish(uint64_t endTick) {
+  for (uint32_t index : m_first) {
+    for (; index != NONE; index = m_next[index]) {
+      m_table->duration[index] = endTick - m_table->start[index];
+      ++m_table->unfinishedNotes;
+    }
+  }
+  m_first.fill(NONE);
+  m_last.fill(NONE);
+}
+
+namespace {
+
+/**
+ * Below this many notes, a merge is not worth splitting up.
+ */
+constexpr size_t PARALLEL_MERGE_THRESHOLD = size_t{1} << 16;
+
+/**
+ * Merges the notes `from[i]` up to `to[i]` of every table `i` into `merged`,
+ * starting at `offset`.
+ */
+void mergeRange(std::span<const NoteTable* const> tables,
+                std::span<const size_t> from, std::span<const size_t> to,
+                NoteTable& merged, size_t offset) {
+  // A heap of the next note of every table, by start tick and then table.
+  struct Cursor {
+    uint64_t start;
+    size_t table;
+    size_t index;
+  };
+  auto before = [](const Cursor& a, const Cursor& b) {
+    return a.start < b.start || (a.start == b.start && a.table < b.table);
+  };
+  std::vector<Cursor> heap;
+  for (size_t i = 0; i < tables.size(); ++i) {
+    if (from[i] < to[i]) {
+      heap.emplace_back(tables[i]->start[from[i]], i, from[i]);
+    }
+  }
+  std::ranges::make_heap(heap, [&](const Cursor& a, const Cursor& b) {
+    return before(b, a);
+  });
+  for (size_t n = offset; !heap.empty(); ++n) {
+    Cursor& c = heap.front();
+    const NoteTable& t = *tables[c.table];
+    merged.start[n] = t.start[c.index];
+    merged.duration[n] = t.duration[c.index];
+    merged.pitch[n] = t.pitch[c.index];
+    merged.velocity[n] = t.velocity[c.index];
+    merged.channel[n] = t.channel[c.index];
+    merged.track[n] = t.track[c.index];
+    if (++c.index < to[c.table]) {
+      c.start = t.start[c.index];
+    } else {
+      c = heap.back();
+      heap.pop_back();
+    }
+    // Sift the new front down, which takes half the comparisons of popping
+    // and pushing it.
+    size_t i = 0;
+    Cursor front = heap.empty() ? Cursor{} : heap.front();
+    for (size_t child = 1; child < heap.size(); child = 2 * i + 1) {
+      if (child + 1 < heap.size() && before(heap[child + 1], heap[child])) {
+        ++child;
+      }
+      if (!before(heap[child], front)) {
+        break;
+      }
+      heap[i] = heap[child];
+      i = child;
+    }
+    if (!heap.empty()) {
+      heap[i] = front;
+    }
+  }
+}
+
+}  // namespace
+
+NoteTable mergeNotes(std::span<const NoteTable* const> tables,
+                     ThreadPool* pool) {
+  NoteTable merged;
+  size_t size = 0;
+  const NoteTable* largest = nullptr;
+  for (const NoteTable* t : tables) {
+    size += t->size();
+    merged.danglingNoteOffs += t->danglingNoteOffs;
+    merged.unfinishedNotes += t->unfinishedNotes;
+    if (!largest || t->size() > largest->size()) {
+      largest = t;
+    }
+  }
+  merged.start.resize(size);
+  merged.duration.resize(size);
+  merged.pitch.resize(size);
+  merged.velocity.resize(size);
+  merged.channel.resize(size);
+  merged.track.resize(size);
+
+  // Ranges end at the start ticks of evenly spaced notes of the largest
+  // table. All notes starting before such a tick come first in the merged
+  // table, so each range has a known place in it.
+  size_t ranges = 1;
+  if (pool && size >= PARALLEL_MERGE_THRESHOLD) {
+    ranges = 4 * (pool->size() + 1);
+  }
+  std::vector<std::vector<size_t>> bounds(ranges + 1,
+                                          std::vector<size_t>(tables.size()));
+  for (size_t i = 0; i < tables.size(); ++i) {
+    bounds.back()[i] = tables[i]->size();
+  }
+  for (size_t r = 1; r < ranges; ++r) {
+    uint64_t tick = largest->start[largest->size() * r / ranges];
+    for (size_t i = 0; i < tables.size(); ++i) {
+      bounds[r][i] = static_cast<size_t>(
+          std::ranges::lower_bound(tables[i]->start, tick) -
+          tables[i]->start.begin());
+    }
+  }
+  auto merge = [&](size_t r) {
+    size_t offset = 0;
+    for (size_t index : bounds[r]) {
+      offset += index;
+    }
+    mergeRange(tables, bounds[r], bounds[r + 1], merged, offset);
+  };
+  if (ranges == 1) {
+    merge(0);
+    return merged;
+  }
+  TaskGroup group(*pool);
+  for (size_t r = 1; r < ranges; ++r) {
+    group.run([&, r] { merge(r); });
+  }
+  merge(0);
+  group.wait();
+  return merged;
+}
+
+}  // namespace MidiParser
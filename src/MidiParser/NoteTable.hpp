@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "events.hpp"
+
+namespace MidiParser {
+
+/**
+ * Notes as spans of time rather than note on and note off events, stored as
+ * a structure of arrays: the columns hold one element per note, ordered by
+ * start tick and then by the order of the note on events. Filled in when
+ * parsing with `ParseOptions::pairNotes`.
+ */
+struct NoteTable {
+
+  /**
+   * The absolute tick of each note's note on event.
+   */
+  std::vector<uint64_t> start;
+
+  /**
+   * The number of ticks until the note off event that ends each note.
+   */
+  std::vector<uint64_t> duration;
+
+  std::vector<uint8_t> pitch;
+  std::vector<uint8_t> velocity;
+  std::vector<uint8_t> channel;
+
+  /**
+   * The index of each note's track in the file's `tracks`.
+   */
+  std::vector<uint16_t> track;
+
+  /**
+   * The number of note off events, or note on events of velocity `0`, that
+   * found no sounding note of their channel and key and were ignored.
+   */
+  size_t danglingNoteOffs = 0;
+
+  /**
+   * The number of notes still sounding at the end of their track. They are
+   * ended at the tick of the track's last event.
+   */
+  size_t unfinishedNotes = 0;
+
+  size_t size() const { return start.size(); }
+
+  void append(uint64_t noteStart, uint64_t noteDuration, uint8_t notePitch,
+              uint8_t noteVelocity, uint8_t noteChannel, uint16_t noteTrack) {
+    start.emplace_back(noteStart);
+    duration.emplace_back(noteDuration);
+    pitch.emplace_back(notePitch);
+    velocity.emplace_back(noteVelocity);
+    channel.emplace_back(noteChannel);
+    track.emplace_back(noteTrack);
+  }
+
+  void clear() { *this = NoteTable{}; }
+
+  bool operator==(const NoteTable&) const = default;
+};
+
+/**
+ * Pairs the note on and note off events of one track into a
+ * `MidiParser::NoteTable`, keeping a queue of sounding notes per channel and
+ * key.
+ *
+ * A note on event with a velocity of `0` is a note off event. Notes of the
+ * same channel and key may overlap: each note off event ends the earliest of
+ * them that is still sounding, first in, first out. Note off events without
+ * a sounding note are counted in `NoteTable::danglingNoteOffs` and otherwise
+ * ignored.
+ */
+class NotePairer {
+ public:
+  /**
+   * Appends the notes of track `track` to `table`, which must outlive the
+   * pairer.
+   */
+  NotePairer(NoteTable& table, uint16_t track);
+
+  /**
+   * Whether `e` is a note on or note off event.
+   */
+  static bool isNote(const EventView& e) {
+    return e.kind == EventKind::MIDI && (e.status & 0xE0) == 0x80 &&
+           e.data.size() >= 2;
+  }
+
+  /**
+   * Pairs `e` at absolute tick `tick` if it is a note on or note off event.
+   * Events must be passed in order.
+   */
+  void add(const EventView& e, uint64_t tick) {
+    if (!isNote(e)) {
+      return;
+    }
+    auto channel = static_cast<uint8_t>(e.status & 0x0F);
+    if ((e.status & 0xF0) == 0x90 && e.data[1] != 0) {
+      noteOn(tick, channel, e.data[0], e.data[1]);
+    } else {
+      noteOff(tick, channel, e.data[0]);
+    }
+  }
+
+  /**
+   * Ends the notes still sounding at `endTick`, the tick of the track's last
+   * event.
+   */
+  void finish(uint64_t endTick);
+
+ private:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  NoteTable* m_table;
+  uint16_t m_track;
+
+  /**
+   * The first and last sounding note of each channel and key, as indices
+   * into `m_table`, or `NONE`.
+   */
+  std::array<uint32_t, 16 * 128> m_first;
+  std::array<uint32_t, 16 * 128> m_last;
+
+  /**
+   * For each note of the table, the next sounding note of its channel and
+   * key, linking the queues of `m_first` and `m_last`.
+   */
+  std::vector<uint32_t> m_next;
+
+  void noteOn(uint64_t tick, uint8_t channel, uint8_t key, uint8_t velocity);
+  void noteOff(uint64_t tick, uint8_t channel, uint8_t key);
+};
+
+/**
+ * Merges the note tables of all tracks, each ordered by start tick, into one
+ * table ordered by start tick. Notes starting at the same tick keep the order
+ * of their tracks in `tables`. Given a `pool`, large tables are cut into
+ * ranges of ticks that are merged in parallel.
+ */
+NoteTable mergeNotes(std::span<const NoteTable* const> tables,
+                     ThreadPool* pool = nullptr);
+
+}  // namespace MidiParser
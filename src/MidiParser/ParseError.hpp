@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace MidiParser {
+
+/**
+ * What went wrong while parsing a MIDI file.
+ */
+enum class ParseErrorKind : uint8_t {
+  /**
+   * The file could not be opened, read or mapped.
+   */
+  IO,
+  /**
+   * The header chunk is missing or incomplete.
+   */
+  INVALID_HEADER,
+  /**
+   * A track chunk is missing, runs past the end of the file, or the chunks
+   * do not add up to the size of the file.
+   */
+  INVALID_CHUNK,
+  /**
+   * An event runs past the end of its track chunk.
+   */
+  TRUNCATED_EVENT,
+  /**
+   * An event cannot be decoded, e.g. because it lacks a status byte and no
+   * running status applies.
+   */
+  INVALID_EVENT,
+  MISSING_END_OF_TRACK,
+  /**
+   * A track chunk goes on after its End of Track event.
+   */
+  DATA_AFTER_END_OF_TRACK,
+  /**
+   * Anything else, such as running out of memory.
+   */
+  OTHER
+};
+
+/**
+ * Describes why a MIDI file could not be parsed, as returned by
+ * `MidiParser::Parser::tryParse`, or why a track was cut short when parsing
+ * with `ParseOptions::lenient`.
+ */
+struct ParseError {
+  ParseErrorKind kind;
+
+  /**
+   * The offset in the file of the byte where the problem was found: the
+   * start of the event that could not be decoded, or of the chunk that is
+   * damaged. `0` for errors without a position, such as `IO`.
+   */
+  size_t offset = 0;
+
+  /**
+   * The index of the track the problem was found in, if any.
+   */
+  std::optional<size_t> track;
+
+  std::string message;
+
+  bool operator==(const ParseError&) const = default;
+};
+
+/**
+ * The exception thrown for malformed MIDI data. It is a `std::runtime_error`
+ * like every other problem with a file, but also remembers the kind of the
+ * problem and where in the decoded data it was found, so that it can be
+ * turned into a `MidiParser::ParseError`.
+ */
+class DecodeError : public std::runtime_error {
+ public:
+  /**
+   * `position` points at the byte where the problem was found. `track` is
+   * the index of the affected track, if known.
+   */
+  DecodeError(ParseErrorKind kind, const uint8_t* position,
+              const std::string& message,
+              std::optional<size_t> track = std::nullopt)
+      : std::runtime_error(message),
+        m_kind(kind),
+        m_position(position),
+        m_track(track) {}
+
+  DecodeError(ParseErrorKind kind, const uint8_t* position,
+              const char* message, std::optional<size_t> track = std::nullopt)
+      : std::runtime_error(message),
+        m_kind(kind),
+        m_position(position),
+        m_track(track) {}
+
+  ParseErrorKind kind() const { return m_kind; }
+
+  /**
+   * Only meaningful while the decoded data is alive.
+   */
+  const uint8_t* position() const { return m_position; }
+
+  std::optional<size_t> track() const { return m_track; }
+
+  /**
+   * Records the index of the track being decoded when the error was thrown.
+   */
+  void setTrack(size_t track) { m_track = track; }
+
+ private:
+  ParseErrorKind m_kind;
+  const uint8_t* m_position;
+  std::optional<size_t> m_track;
+};
+
+}  // namespace MidiParser
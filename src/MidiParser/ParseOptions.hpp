@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+
+#include "EventFilter.hpp"
+
+namespace MidiParser {
+
+/**
+ * Settings controlling how a `MidiParser::Parser` parses files.
+ */
+struct ParseOptions {
+
+  /**
+   * Track chunks smaller than this many bytes are decoded on the thread
+   * calling `parse` instead of being handed to the thread pool, where the
+   * hand-off would cost more than the decoding itself.
+   */
+  size_t inlineTrackThreshold = 4096;
+
+  /**
+   * Track chunks of at least this many bytes are split into segments that
+   * are decoded on the thread pool in parallel, so that single huge tracks
+   * use more than one core. A pass over the track finds the event boundaries
+   * to split at first. Segments are no smaller than `inlineTrackThreshold`.
+   * Does not apply with `maxEventsPerTrack` or `maxTick` set, or to a pool
+   * without workers.
+   */
+  size_t splitTrackThreshold = size_t{8} << 20;
+
+  /**
+   * Recover from damaged chunk structure instead of throwing: skip junk before
+   * the header, locate tracks by scanning for `MTrk` and cut off tracks whose
+   * declared length runs past the end of the file. Files parsed this way may
+   * contain fewer tracks than `numTracks`.
+   */
+  bool recoverChunks = false;
+
+  /**
+   * Keep the events of a track decoded before a malformed event instead of
+   * failing the whole file: the track ends there and the error is recorded
+   * in the file's `errors`. Damaged chunk structure still fails the file,
+   * unless `recoverChunks` is also set. The handler overloads of `parse`
+   * ignore this.
+   */
+  bool lenient = false;
+
+  /**
+   * Record the absolute tick of every kept event in the tracks'
+   * `absoluteTicks` and build the file's `tempoMap` while decoding, so times
+   * can be converted and tracks seeked without rescanning them. The tempo
+   * map sees tempo changes even if `filter` skips them. Format 2 files get
+   * `absoluteTicks` but no tempo map.
+   */
+  bool buildTimeIndex = false;
+
+  /**
+   * Pair the note on and note off events of every track into its `notes`
+   * table while it is decoded (see `MidiParser::NotePairer`), and merge them
+   * into the file's `notes`. Notes are paired from every decoded event, even
+   * those `filter` skips, so a filter that keeps no events yields only the
+   * notes.
+   */
+  bool pairNotes = false;
+
+  /**
+   * Where the events, payload and time index of `parseFlat` output are
+   * allocated, or `nullptr` for `std::pmr::get_default_resource()`. Only
+   * `parseFlat` uses it: `parse`, `parseColumnar` and `parseMany` allocate
+   * their output with the global allocator regardless. Each buffer is
+   * allocated once at its final size and only from the thread calling
+   * `parseFlat`, so the resource does not need to be thread-safe. With a
+   * `std::pmr::monotonic_buffer_resource`, all output of many files can be
+   * freed at once by releasing the resource.
+   */
+  std::pmr::memory_resource* memoryResource = nullptr;
+
+  /**
+   * Which events to keep. Skipped events are decoded only far enough to step
+   * over them.
+   */
+  EventFilter filter = EventFilter::all();
+
+  /**
+   * Stop decoding a track once this many events have been kept from it.
+   */
+  size_t maxEventsPerTrack = std::numeric_limits<size_t>::max();
+
+  /**
+   * Stop decoding a track at its first event after this absolute tick. With
+   * `0`, only the events at the very start of each track are read, which is
+   * where track names, tempo and time signature usually are.
+   */
+  uint64_t maxTick = std::numeric_limits<uint64_t>::max();
+
+  /**
+   * Record what each `parse`, `parseFlat` and `parseColumnar` call took in
+   * `MidiParser::Parser::stats`. Has no effect unless the library was built
+   * with the `MIDI_PARSER_STATS` CMake option, see
+   * `MidiParser::STATS_ENABLED`.
+   */
+  bool collectStats = false;
+};
+
+}  // namespace MidiParser
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "enums.hpp"
+
+namespace MidiParser {
+
+/**
+ * Whether the library was built with the `MIDI_PARSER_STATS` CMake option.
+ * Without it, all statistics code is compiled out and
+ * `ParseOptions::collectStats` has no effect.
+ */
+#ifdef MIDIPARSER_STATS
+inline constexpr bool STATS_ENABLED = true;
+#else
+inline constexpr bool STATS_ENABLED = false;
+#endif
+
+/**
+ * What decoding a single track chunk took.
+ */
+struct TrackStats {
+  /**
+   * The size of the track chunk's data.
+   */
+  size_t bytes = 0;
+
+  /**
+   * The number of events decoded, including those skipped by the filter.
+   */
+  uint64_t decodedEvents = 0;
+
+  /**
+   * The number of events kept, indexed by `MidiParser::EventKind`.
+   */
+  std::array<uint64_t, 3> events{};
+
+  std::chrono::nanoseconds decodeTime{};
+
+  /**
+   * The number and total size of the allocations made for the track's
+   * output, counted from the growth of its buffers.
+   */
+  uint64_t allocations = 0;
+  uint64_t allocatedBytes = 0;
+
+  /**
+   * The thread the track was decoded on.
+   */
+  std::thread::id thread;
+};
+
+/**
+ * What a single `parse` or `parseFlat` call took, as recorded when
+ * `ParseOptions::collectStats` is set. See `MidiParser::Parser::stats`.
+ */
+struct ParseStats {
+  /**
+   * The size of the file.
+   */
+  uint64_t bytesRead = 0;
+
+  /**
+   * The number of events kept across all tracks, indexed by
+   * `MidiParser::EventKind`.
+   */
+  std::array<uint64_t, 3> events{};
+
+  std::vector<TrackStats> tracks;
+
+  /**
+   * Time spent reading or mapping the file. `0` for in-memory input.
+   */
+  std::chrono::nanoseconds ioTime{};
+
+  /**
+   * Wall-clock time from locating the chunks to having the output ready.
+   */
+  std::chrono::nanoseconds decodeTime{};
+
+  /**
+   * The sums of `TrackStats::allocations` and `TrackStats::allocatedBytes`,
+   * plus the allocations made to assemble the output.
+   */
+  uint64_t allocations = 0;
+  uint64_t allocatedBytes = 0;
+
+  /**
+   * The threads that could decode tracks: the pool's workers and the calling
+   * thread.
+   */
+  size_t threadsAvailable = 0;
+
+  /**
+   * The number of distinct threads that decoded at least one track.
+   */
+  size_t threadsUsed = 0;
+
+  /**
+   * The number of kept events of kind `kind`.
+   */
+  uint64_t eventCount(EventKind kind) const {
+    return events[static_cast<size_t>(kind)];
+  }
+
+  /**
+   * The share of the available thread time during `decodeTime` that was spent
+   * decoding tracks, between `0` and `1`.
+   */
+  double utilization() const {
+    std::chrono::nanoseconds busy{};
+    for (const auto& t : tracks) {
+      busy += t.decodeTime;
+    }
+    double available = static_cast<double>(decodeTime.count()) *
+                       static_cast<double>(threadsAvailable);
+    return available > 0 ? static_cast<double>(busy.count()) / available : 0;
+  }
+};
+
+}  // namespace MidiParser
@@ -1,108 +1,1259 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <format>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+#include <variant>
 
+#include "MappedFile.hpp"
+#include "NoteTable.hpp"
+#include "ParseError.hpp"
 #include "Parser.hpp"
+#include "chunks.hpp"
+#include "decode.hpp"
 #include "read.hpp"
 
 namespace MidiParser {
 
+namespace {
+
+/**
+ * Reads the chunks of `data` with `readChunks`, or `recoverChunks` if the
+ * options ask for it.
+ */
+Header splitChunks(std::span<const std::byte> data,
+                   std::vector<std::span<const byte>>& trackData,
+                   const ParseOptions& options) {
+  std::span<const byte> bytes(reinterpret_cast<const byte*>(data.data()),
+                              data.size());
+  if (options.recoverChunks) {
+    return recoverChunks(bytes, trackData);
+  }
+  return readChunks(bytes, trackData);
+}
+
+/**
+ * The current time if statistics are compiled in, so that timing costs
+ * nothing otherwise.
+ */
+std::chrono::steady_clock::time_point statsClock() {
+  if constexpr (STATS_ENABLED) {
+    return std::chrono::steady_clock::now();
+  }
+  return {};
+}
+
+/**
+ * Describes `e`, thrown while parsing `data`, as a `ParseError`.
+ */
+ParseError toParseError(const DecodeError& e, std::span<const std::byte> data) {
+  auto position = reinterpret_cast<const std::byte*>(e.position());
+  bool inData =
+      position >= data.data() && position <= data.data() + data.size();
+  return ParseError{
+      .kind = e.kind(),
+      .offset = inData ? static_cast<size_t>(position - data.data()) : 0,
+      .track = e.track(),
+      .message = e.what()};
+}
+
+/**
+ * Describes the exception being handled, thrown while parsing `data`, as a
+ * `ParseError`. Must be called from a `catch` block.
+ */
+ParseError currentError(std::span<const std::byte> data) noexcept {
+  try {
+    try {
+      throw;
+    } catch (const DecodeError& e) {
+      return toParseError(e, data);
+    } catch (const std::ios_base::failure& e) {
+      return ParseError{.kind = ParseErrorKind::IO, .message = e.what()};
+    } catch (const std::exception& e) {
+      return ParseError{.kind = ParseErrorKind::OTHER, .message = e.what()};
+    }
+  } catch (...) {
+    // Either not a standard exception, or copying its message failed.
+    return ParseError{.kind = ParseErrorKind::OTHER};
+  }
+}
+
+/**
+ * What `parseAllTrackData` hands to the function parsing one track besides
+ * the track itself. `tempos` is set if the options ask for a time index,
+ * `stats` if they ask for statistics and `notes` if they ask for notes.
+ * `error` is where a problem that ends the track is stored. `pool` is where
+ * large tracks may be split up.
+ */
+struct TrackContext {
+  const ParseOptions& options;
+  std::vector<TempoChange>* tempos;
+  TrackStats* stats;
+  NotePairer* notes;
+  std::optional<DecodeFailure>* error;
+  ThreadPool* pool;
+};
+
+/**
+ * The columns of one track of a `ColumnarMidiFile`, decoded separately and
+ * concatenated afterwards. `payloadOffsets` leaves out the leading `0`.
+ */
+struct ColumnarTrack {
+  std::vector<uint64_t> tick;
+  std::vector<EventKind> kind;
+  std::vector<uint8_t> status;
+  std::vector<uint8_t> data1;
+  std::vector<uint8_t> data2;
+  std::vector<uint32_t> payloadOffsets;
+  std::vector<uint8_t> payload;
+  NoteTable notes;
+};
+
+/**
+ * Runs `append`, which may grow `buffer`, and counts the allocation in
+ * `stats` if it did.
+ */
+template <typename Buffer, typename Append>
+void countGrowth(TrackStats* stats, const Buffer& buffer, Append&& append) {
+  if constexpr (STATS_ENABLED) {
+    if (stats) {
+      size_t before = buffer.capacity();
+      append();
+      if (buffer.capacity() != before) {
+        ++stats->allocations;
+        stats->allocatedBytes +=
+            buffer.capacity() * sizeof(typename Buffer::value_type);
+      }
+      return;
+    }
+  }
+  append();
+}
+
+/**
+ * Appends a copy of the event viewed by `e` to `track`.
+ */
+void appendEvent(MidiTrack& track, const EventView& e, TrackStats* stats) {
+  countGrowth(stats, track.events,
+              [&] { track.events.emplace_back(toTrackEvent(e)); });
+  if constexpr (STATS_ENABLED) {
+    // Every event with data owns a vector of it.
+    if (stats && !e.data.empty()) {
+      ++stats->allocations;
+      stats->allocatedBytes += e.data.size();
+    }
+  }
+}
+
+void appendEvent(FlatTrack& track, const EventView& e, TrackStats* stats) {
+  countGrowth(stats, track.payload, [&] {
+    countGrowth(stats, track.events, [&] { track.append(e); });
+  });
+}
+
+void appendEvent(ColumnarTrack& track, const EventView& e, TrackStats* stats) {
+  uint8_t data[2] = {};
+  if (e.kind == EventKind::MIDI) {
+    std::copy_n(e.data.begin(), std::min<size_t>(e.data.size(), 2), data);
+  } else {
+    countGrowth(stats, track.payload, [&] {
+      track.payload.insert(track.payload.end(), e.data.begin(), e.data.end());
+    });
+  }
+  countGrowth(stats, track.kind, [&] { track.kind.emplace_back(e.kind); });
+  countGrowth(stats, track.status,
+              [&] { track.status.emplace_back(e.status); });
+  countGrowth(stats, track.data1, [&] { track.data1.emplace_back(data[0]); });
+  countGrowth(stats, track.data2, [&] { track.data2.emplace_back(data[1]); });
+  countGrowth(stats, track.payloadOffsets, [&] {
+    track.payloadOffsets.emplace_back(
+        static_cast<uint32_t>(track.payload.size()));
+  });
+}
+
+/**
+ * Records the absolute tick of an event appended to `track` if the options
+ * ask for a time index.
+ */
+template <typename Track>
+void appendTick(Track& track, uint64_t tick, bool timeIndex,
+                TrackStats* stats) {
+  if (timeIndex) {
+    countGrowth(stats, track.absoluteTicks,
+                [&] { track.absoluteTicks.emplace_back(tick); });
+  }
+}
+
+void appendTick(ColumnarTrack& track, uint64_t tick, bool, TrackStats* stats) {
+  countGrowth(stats, track.tick, [&] { track.tick.emplace_back(tick); });
+}
+
+/**
+ * Returns the `observe` and `emit` callbacks for `decodeEvents` that append
+ * the kept events to `track` and record the time index, notes and
+ * statistics the context asks for.
+ */
+template <typename Track>
+auto trackCallbacks(Track& track, const TrackContext& context) {
+  auto* tempos = context.tempos;
+  auto* stats = context.stats;
+  auto* notes = context.notes;
+  auto observe = [tempos, stats, notes](const EventView& e, uint64_t tick) {
+    if constexpr (STATS_ENABLED) {
+      if (stats) {
+        ++stats->decodedEvents;
+      }
+    }
+    if (notes) {
+      notes->add(e, tick);
+    }
+    if (tempos && e.kind == EventKind::META &&
+        e.status == static_cast<uint8_t>(Meta::SET_TEMPO) &&
+        e.data.size() == 3) {
+      tempos->emplace_back(tick, static_cast<uint32_t>(e.data[0] << 16 |
+                                                       e.data[1] << 8 |
+                                                       e.data[2]));
+    }
+  };
+  auto emit = [&track, tempos, stats](const EventView& e, uint64_t tick) {
+    appendTick(track, tick, tempos != nullptr, stats);
+    appendEvent(track, e, stats);
+    if constexpr (STATS_ENABLED) {
+      if (stats) {
+        ++stats->events[static_cast<size_t>(e.kind)];
+      }
+    }
+  };
+  return std::pair(observe, emit);
+}
+
+/**
+ * Whether `data` is to be decoded with `decodeSplit`, see
+ * `ParseOptions::splitTrackThreshold`.
+ */
+bool shouldSplit(std::span<const byte> data, const TrackContext& context) {
+  const ParseOptions& options = context.options;
+  return context.pool && context.pool->size() > 0 &&
+         data.size() >= options.splitTrackThreshold &&
+         options.maxEventsPerTrack == std::numeric_limits<size_t>::max() &&
+         options.maxTick == std::numeric_limits<uint64_t>::max();
+}
+
+/**
+ * Adds `delta` to the delta time of the first event of `segment`.
+ */
+void addDelta(MidiTrack& segment, uint64_t delta) {
+  std::visit(
+      [&](auto& event) { event.deltaTime += static_cast<uint32_t>(delta); },
+      segment.events.front());
+}
+
+void addDelta(FlatTrack& segment, uint64_t delta) {
+  segment.events.front().deltaTime += static_cast<uint32_t>(delta);
+}
+
+void addDelta(ColumnarTrack&, uint64_t) {
+  // Columnar events have absolute ticks only.
+}
+
+/**
+ * Appends the absolute ticks of `segment` to those of `track`.
+ */
+template <typename Track>
+void appendSegmentTicks(Track& track, const Track& segment,
+                        TrackStats* stats) {
+  countGrowth(stats, track.absoluteTicks, [&] {
+    track.absoluteTicks.insert(track.absoluteTicks.end(),
+                               segment.absoluteTicks.begin(),
+                               segment.absoluteTicks.end());
+  });
+}
+
+/**
+ * Appends the events of `segment` to those of `track`.
+ */
+void appendSegment(MidiTrack& track, MidiTrack& segment, TrackStats* stats) {
+  countGrowth(stats, track.events, [&] {
+    track.events.insert(track.events.end(),
+                        std::make_move_iterator(segment.events.begin()),
+                        std::make_move_iterator(segment.events.end()));
+  });
+  appendSegmentTicks(track, segment, stats);
+}
+
+void appendSegment(FlatTrack& track, FlatTrack& segment, TrackStats* stats) {
+  auto base = static_cast<uint32_t>(track.payload.size());
+  for (auto& e : segment.events) {
+    if (e.kind != EventKind::MIDI) {
+      e.payloadOffset += base;
+    }
+  }
+  countGrowth(stats, track.events, [&] {
+    track.events.insert(track.events.end(), segment.events.begin(),
+                        segment.events.end());
+  });
+  countGrowth(stats, track.payload, [&] {
+    track.payload.insert(track.payload.end(), segment.payload.begin(),
+                         segment.payload.end());
+  });
+  appendSegmentTicks(track, segment, stats);
+}
+
+void appendSegment(ColumnarTrack& track, ColumnarTrack& segment,
+                   TrackStats* stats) {
+  auto base = static_cast<uint32_t>(track.payload.size());
+  for (uint32_t& offset : segment.payloadOffsets) {
+    offset += base;
+  }
+  auto append = [stats](auto& column, const auto& from) {
+    countGrowth(stats, column,
+                [&] { column.insert(column.end(), from.begin(), from.end()); });
+  };
+  append(track.tick, segment.tick);
+  append(track.kind, segment.kind);
+  append(track.status, segment.status);
+  append(track.data1, segment.data1);
+  append(track.data2, segment.data2);
+  append(track.payloadOffsets, segment.payloadOffsets);
+  append(track.payload, segment.payload);
+}
+
+/**
+ * Decodes a large track in segments on the context's pool. A pass over the
+ * whole track, which also validates it, finds the points to split at; the
+ * segments are then decoded in parallel and stitched together in order.
+ * Notes cannot be paired within a segment, as they may start in an earlier
+ * one, so the segments collect their note events to be paired in order
+ * afterwards. Returns what is wrong, without decoding anything, if the track
+ * is malformed.
+ */
+template <typename Track>
+std::expected<void, DecodeFailure> decodeSplit(std::span<const byte> data,
+                                               Track& track,
+                                               const TrackContext& context) {
+  ThreadPool& pool = *context.pool;
+  // A few segments per thread even out their differing decode costs.
+  size_t segmentSize = std::max<size_t>(
+      {data.size() / (4 * (pool.size() + 1)),
+       context.options.inlineTrackThreshold, 1});
+  auto found = findSplitPoints(data, segmentSize);
+  if (!found) {
+    return std::unexpected(found.error());
+  }
+  const auto& points = *found;
+
+  struct Segment {
+    Track track;
+    std::vector<TempoChange> tempos;
+    TrackStats stats;
+    std::optional<uint64_t> lastKept;
+    std::vector<std::pair<EventView, uint64_t>> notes;
+    uint64_t endTick;
+  };
+  std::vector<Segment> segments(points.size());
+  auto decode = [&](size_t k) {
+    Segment& segment = segments[k];
+    TrackContext segmentContext{context.options,
+                                context.tempos ? &segment.tempos : nullptr,
+                                context.stats ? &segment.stats : nullptr,
+                                nullptr, nullptr, nullptr};
+    auto [observe, emit] = trackCallbacks(segment.track, segmentContext);
+    size_t end = k + 1 < points.size() ? points[k + 1].offset : data.size();
+    segment.endTick = decodeSegment(
+        data.first(end), points[k], context.options.filter,
+        [&](const EventView& e, uint64_t tick) {
+          observe(e, tick);
+          if (context.notes && NotePairer::isNote(e)) {
+            segment.notes.emplace_back(e, tick);
+          }
+        },
+        [&](const EventView& e, uint64_t tick) {
+          emit(e, tick);
+          segment.lastKept = tick;
+        });
+  };
+  TaskGroup group(pool);
+  for (size_t k = 1; k < segments.size(); ++k) {
+    group.run([&, k] { decode(k); });
+  }
+  decode(0);
+  group.wait();
+
+  // Each segment measured the delta time of its first kept event from its
+  // own start, which may lie after the previous kept event.
+  uint64_t lastKept = 0;
+  for (size_t k = 0; k < segments.size(); ++k) {
+    Segment& segment = segments[k];
+    if (!segment.lastKept) {
+      continue;
+    }
+    addDelta(segment.track, points[k].tick - lastKept);
+    lastKept = *segment.lastKept;
+    appendSegment(track, segment.track, context.stats);
+  }
+  for (auto& segment : segments) {
+    if (context.notes) {
+      for (const auto& [e, tick] : segment.notes) {
+        context.notes->add(e, tick);
+      }
+    }
+    if (context.tempos) {
+      context.tempos->insert(context.tempos->end(), segment.tempos.begin(),
+                             segment.tempos.end());
+    }
+    if constexpr (STATS_ENABLED) {
+      // Allocations made for the segments are not counted, only those of the
+      // stitched track.
+      if (context.stats) {
+        context.stats->decodedEvents += segment.stats.decodedEvents;
+        for (size_t i = 0; i < segment.stats.events.size(); ++i) {
+          context.stats->events[i] += segment.stats.events[i];
+        }
+      }
+    }
+  }
+  if (context.notes) {
+    context.notes->finish(segments.back().endTick);
+  }
+  return {};
+}
+
+/**
+ * Decodes the events of a track chunk into `track`, in segments on the pool
+ * if it is large enough. A malformed event ends the track and is stored in
+ * the context's `error`. The events before it are kept if the options are
+ * lenient.
+ */
+template <typename Track>
+void decodeTrack(std::span<const byte> data, Track& track,
+                 const TrackContext& context) {
+  if (shouldSplit(data, context)) {
+    auto split = decodeSplit(data, track, context);
+    if (split) {
+      return;
+    }
+    if (!context.options.lenient) {
+      *context.error = split.error();
+      return;
+    }
+    // The whole track is validated before any segment is decoded, so
+    // nothing was kept. Decoding it serially keeps the events before the
+    // error.
+  }
+  auto [observe, emit] = trackCallbacks(track, context);
+  uint64_t endTick = 0;
+  auto decoded = decodeEvents(
+      data, context.options,
+      [&](const EventView& e, uint64_t tick) {
+        endTick = tick;
+        observe(e, tick);
+      },
+      emit);
+  if (!decoded) {
+    *context.error = decoded.error();
+  }
+  if (context.notes) {
+    context.notes->finish(endTick);
+  }
+}
+
+void parseTrackData(std::span<const byte> data, MidiTrack& track,
+                    const TrackContext& context) {
+  track.length = static_cast<uint32_t>(data.size());
+  decodeTrack(data, track, context);
+}
+
+void parseFlatTrackData(std::span<const byte> data, FlatTrack& track,
+                        const TrackContext& context) {
+  track.length = static_cast<uint32_t>(data.size());
+  // Most events take three or more bytes, so this avoids nearly all regrowth
+  // without overallocating much.
+  countGrowth(context.stats, track.events,
+              [&] { track.events.reserve(data.size() / 3); });
+  if (context.tempos) {
+    countGrowth(context.stats, track.absoluteTicks,
+                [&] { track.absoluteTicks.reserve(data.size() / 3); });
+  }
+  decodeTrack(data, track, context);
+}
+
+void resetTrack(MidiTrack& track) {
+  track.events.clear();
+  track.absoluteTicks.clear();
+  track.notes.clear();
+}
+
+void parseColumnarTrackData(std::span<const byte> data, ColumnarTrack& track,
+                            const TrackContext& context) {
+  decodeTrack(data, track, context);
+}
+
+void resetTrack(ColumnarTrack& track) {
+  track.tick.clear();
+  track.kind.clear();
+  track.status.clear();
+  track.data1.clear();
+  track.data2.clear();
+  track.payloadOffsets.clear();
+  track.payload.clear();
+  track.notes.clear();
+}
+
+void resetTrack(FlatTrack& track) {
+  track.events.clear();
+  track.payload.clear();
+  track.absoluteTicks.clear();
+  track.notes.clear();
+}
+
+/**
+ * Copies `track` into buffers allocated from `resource` at their exact size.
+ * Its notes are moved rather than copied.
+ */
+FlatTrack copyTrack(FlatTrack& track, std::pmr::memory_resource* resource) {
+  return FlatTrack{
+      .length = track.length,
+      .events = {track.events.begin(), track.events.end(), resource},
+      .payload = {track.payload.begin(), track.payload.end(), resource},
+      .absoluteTicks = {track.absoluteTicks.begin(), track.absoluteTicks.end(),
+                        resource},
+      .notes = std::move(track.notes)};
+}
+
+/**
+ * Concatenates the columns of `tracks` into those of `file`.
+ */
+void joinColumns(std::vector<ColumnarTrack>& tracks, ColumnarMidiFile& file) {
+  size_t events = 0;
+  size_t payload = 0;
+  for (const auto& t : tracks) {
+    events += t.tick.size();
+    payload += t.payload.size();
+  }
+  if (payload > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("Meta and SysEx data exceed 4 GiB.");
+  }
+  file.tick.reserve(events);
+  file.kind.reserve(events);
+  file.status.reserve(events);
+  file.data1.reserve(events);
+  file.data2.reserve(events);
+  file.track.reserve(events);
+  file.payloadOffsets.reserve(events + 1);
+  file.payload.reserve(payload);
+  file.trackOffsets.reserve(tracks.size() + 1);
+  auto append = [](auto& column, const auto& from) {
+    column.insert(column.end(), from.begin(), from.end());
+  };
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    const ColumnarTrack& t = tracks[i];
+    auto base = static_cast<uint32_t>(file.payload.size());
+    append(file.tick, t.tick);
+    append(file.kind, t.kind);
+    append(file.status, t.status);
+    append(file.data1, t.data1);
+    append(file.data2, t.data2);
+    file.track.insert(file.track.end(), t.tick.size(),
+                      static_cast<uint16_t>(i));
+    for (uint32_t offset : t.payloadOffsets) {
+      file.payloadOffsets.emplace_back(base + offset);
+    }
+    append(file.payload, t.payload);
+    file.trackOffsets.emplace_back(file.tick.size());
+  }
+}
+
+/**
+ * Merges the notes of `tracks` on `pool` if the options ask for notes.
+ */
+template <typename Track>
+std::optional<NoteTable> fileNotes(ThreadPool& pool,
+                                   const ParseOptions& options,
+                                   const std::vector<Track>& tracks) {
+  if (!options.pairNotes) {
+    return std::nullopt;
+  }
+  std::vector<const NoteTable*> tables;
+  tables.reserve(tracks.size());
+  for (const auto& t : tracks) {
+    tables.emplace_back(&t.notes);
+  }
+  return mergeNotes(tables, &pool);
+}
+
+/**
+ * Adds the per-track statistics up into the totals of `stats`.
+ */
+void summarizeTracks(ParseStats& stats, const ThreadPool& pool) {
+  std::vector<std::thread::id> threads;
+  for (const auto& t : stats.tracks) {
+    for (size_t k = 0; k < stats.events.size(); ++k) {
+      stats.events[k] += t.events[k];
+    }
+    stats.allocations += t.allocations;
+    stats.allocatedBytes += t.allocatedBytes;
+    threads.emplace_back(t.thread);
+  }
+  std::ranges::sort(threads);
+  stats.threadsUsed = static_cast<size_t>(
+      std::ranges::unique(threads).begin() - threads.begin());
+  stats.threadsAvailable = pool.size() + 1;
+}
+
+/**
+ * What `parseAllTrackData` collects from the tracks as a whole.
+ */
+struct TrackResults {
+  /**
+   * Present if the options ask for a time index.
+   */
+  std::optional<TempoMap> tempoMap;
+
+  /**
+   * The errors that ended tracks early if the options are lenient.
+   */
+  std::vector<ParseError> errors;
+
+  /**
+   * The error of the first malformed track if the options are not lenient,
+   * which fails the whole file.
+   */
+  std::optional<DecodeError> error;
+};
+
+/**
+ * Decodes the tracks of one file into the matching elements of `tracks`,
+ * one `parse` call per track, and collects what they have in common once
+ * all are done. Elements already in `tracks` are reused along with their
+ * capacity. Fills in the track statistics of `stats` if given.
+ */
+template <typename Track>
+class TrackSet {
+ public:
+  using ParseTrack = void (*)(std::span<const byte>, Track&,
+                              const TrackContext&);
+
+  /**
+   * Prepares to decode `trackData`, whose elements may still be filled in
+   * later but before the `parse` call for them.
+   */
+  TrackSet(ThreadPool& pool, const ParseOptions& options,
+           const std::vector<std::span<const byte>>& trackData,
+           std::vector<Track>& tracks, ParseStats* stats,
+           ParseTrack parseTrack)
+      : m_pool(pool),
+        m_options(options),
+        m_trackData(trackData),
+        m_tracks(tracks),
+        m_stats(stats),
+        m_parseTrack(parseTrack) {
+    tracks.resize(trackData.size());
+    for (auto& t : tracks) {
+      resetTrack(t);
+    }
+    if (options.buildTimeIndex) {
+      m_tempos.resize(trackData.size());
+    }
+    m_errors.resize(trackData.size());
+    if (stats) {
+      stats->tracks.assign(trackData.size(), TrackStats{});
+    }
+  }
+
+  /**
+   * Decodes track `i`. Tracks may be decoded concurrently. A malformed track
+   * is not thrown but kept for `finish`, so that it fails the file without
+   * unwinding through the pool. Unless the options are lenient, tracks not
+   * started yet are skipped from then on.
+   */
+  void parse(size_t i) {
+    if (m_failed) {
+      return;
+    }
+    decode(i);
+    if (m_errors[i] && !m_options.lenient) {
+      m_failed = true;
+    }
+  }
+
+  /**
+   * Merges the tempo changes and gathers the errors of all tracks once they
+   * have been decoded. `data` is the file `trackData` points into.
+   */
+  TrackResults finish(const Header& header, std::span<const std::byte> data) {
+    if (m_stats) {
+      summarizeTracks(*m_stats, m_pool);
+    }
+    TrackResults results;
+    for (size_t i = 0; i < m_errors.size(); ++i) {
+      if (!m_errors[i]) {
+        continue;
+      }
+      DecodeError error = toDecodeError(*m_errors[i]);
+      error.setTrack(i);
+      if (!m_options.lenient) {
+        results.error.emplace(std::move(error));
+        return results;
+      }
+      results.errors.emplace_back(toParseError(error, data));
+    }
+    // The tracks of a format 2 file are independent sequences, each with
+    // tempo changes of its own, so no map can be shared by them.
+    if (m_options.buildTimeIndex && header.fileFormat != 2) {
+      std::vector<TempoChange> merged;
+      for (const auto& t : m_tempos) {
+        merged.insert(merged.end(), t.begin(), t.end());
+      }
+      std::ranges::stable_sort(merged, {}, &TempoChange::tick);
+      results.tempoMap.emplace(header.tickDivision, merged);
+    }
+    return results;
+  }
+
+ private:
+  ThreadPool& m_pool;
+  const ParseOptions& m_options;
+  const std::vector<std::span<const byte>>& m_trackData;
+  std::vector<Track>& m_tracks;
+  ParseStats* m_stats;
+  ParseTrack m_parseTrack;
+  std::vector<std::vector<TempoChange>> m_tempos;
+  std::vector<std::optional<DecodeFailure>> m_errors;
+  std::atomic<bool> m_failed = false;
+
+  void decode(size_t i) {
+    std::optional<NotePairer> notes;
+    if (m_options.pairNotes) {
+      notes.emplace(m_tracks[i].notes, static_cast<uint16_t>(i));
+    }
+    TrackContext context{m_options,
+                         m_tempos.empty() ? nullptr : &m_tempos[i],
+                         m_stats ? &m_stats->tracks[i] : nullptr,
+                         notes ? &*notes : nullptr,
+                         &m_errors[i],
+                         &m_pool};
+    if constexpr (STATS_ENABLED) {
+      if (m_stats) {
+        auto start = statsClock();
+        m_parseTrack(m_trackData[i], m_tracks[i], context);
+        context.stats->decodeTime = statsClock() - start;
+        context.stats->bytes = m_trackData[i].size();
+        context.stats->thread = std::this_thread::get_id();
+        return;
+      }
+    }
+    m_parseTrack(m_trackData[i], m_tracks[i], context);
+  }
+};
+
+/**
+ * Parses every track in `trackData`, which points into `data`, into the
+ * matching element of `tracks` with a `TrackSet`. Tracks below the inline
+ * threshold are parsed on the calling thread while the pool works on the
+ * larger ones.
+ */
+template <typename Track>
+TrackResults parseAllTrackData(
+    ThreadPool& pool, const ParseOptions& options, const Header& header,
+    std::span<const std::byte> data,
+    const std::vector<std::span<const byte>>& trackData,
+    std::vector<Track>& tracks, ParseStats* stats,
+    typename TrackSet<Track>::ParseTrack parseTrack) {
+  TrackSet<Track> set(pool, options, trackData, tracks, stats, parseTrack);
+  TaskGroup group(pool);
+  std::vector<size_t> inlineTracks;
+  for (size_t i = 0; i < trackData.size(); ++i) {
+    if (trackData[i].size() < options.inlineTrackThreshold) {
+      inlineTracks.emplace_back(i);
+    } else {
+      group.run([&, i] { set.parse(i); });
+    }
+  }
+  for (size_t i : inlineTracks) {
+    set.parse(i);
+  }
+  group.wait();
+  return set.finish(header, data);
+}
+
+/**
+ * Parses `data` without a `Parser`'s buffers for `parseMany`. A malformed
+ * track is returned as the error of the whole file, while damaged chunks
+ * throw.
+ */
+std::expected<MidiFile, DecodeError> parseStateless(
+    ThreadPool& pool, const ParseOptions& options,
+    std::span<const std::byte> data) {
+  std::vector<std::span<const byte>> trackData;
+  std::vector<MidiTrack> tracks;
+  Header header = splitChunks(data, trackData, options);
+  auto results = parseAllTrackData(pool, options, header, data, trackData,
+                                   tracks, nullptr, parseTrackData);
+  if (results.error) {
+    return std::unexpected(std::move(*results.error));
+  }
+  auto notes = fileNotes(pool, options, tracks);
+  return MidiFile{.fileFormat = header.fileFormat,
+                  .numTracks = header.numTracks,
+                  .tickDivision = header.tickDivision,
+                  .tracks = std::move(tracks),
+                  .tempoMap = std::move(results.tempoMap),
+                  .notes = std::move(notes),
+                  .errors = std::move(results.errors)};
+}
+
+std::expected<MidiFile, DecodeError> parseStateless(
+    ThreadPool& pool, const ParseOptions& options, const std::string& path) {
+  MappedFile file(path);
+  return parseStateless(pool, options, file.bytes());
+}
+
+/**
+ * A file of `parseMany` with a `FileReader`, whose tracks are decoded as soon
+ * as their chunks have arrived. `pending` counts the tracks being decoded,
+ * plus one until the file has been read completely. Whoever brings it to
+ * zero finishes the file.
+ */
+struct StreamedFile {
+  std::unique_ptr<std::byte[]> buffer;
+  std::span<const std::byte> data;
+
+  /**
+   * The number of bytes at the start of `data` that have arrived.
+   */
+  size_t arrived = 0;
+
+  std::optional<Header> header;
+  std::vector<std::span<const byte>> trackData;
+  std::vector<MidiTrack> tracks;
+  std::optional<TrackSet<MidiTrack>> set;
+
+  /**
+   * The number of tracks found so far and the offset of the next track
+   * chunk.
+   */
+  size_t foundTracks = 0;
+  size_t offset = HEADER_SIZE;
+
+  std::atomic<size_t> pending = 1;
+  std::atomic<bool> failed = false;
+  std::mutex mutex;
+  std::exception_ptr error;
+
+  std::span<const byte> bytes() const {
+    return {reinterpret_cast<const byte*>(data.data()), data.size()};
+  }
+
+  /**
+   * Records `e` as the reason the file failed, unless it already has one.
+   */
+  void fail(std::exception_ptr e) {
+    std::lock_guard lock(mutex);
+    if (!error) {
+      error = e;
+    }
+    failed = true;
+  }
+};
+
+/**
+ * Finds the track chunks of `file` that have arrived completely since the
+ * last call and passes the index of each to `decode`. The chunks are read
+ * like `splitChunks` would, which needs the whole file when recovering
+ * damaged chunk structure. Throws a `DecodeError` if they are damaged.
+ */
+template <typename Decode>
+void scanArrived(StreamedFile& file, ThreadPool& pool,
+                 const ParseOptions& options, Decode&& decode) {
+  auto bytes = file.bytes();
+  if (!file.set) {
+    if (options.recoverChunks) {
+      if (file.arrived < bytes.size()) {
+        return;
+      }
+      file.header = recoverChunks(bytes, file.trackData);
+    } else {
+      if (file.arrived < std::min(HEADER_SIZE, bytes.size())) {
+        return;
+      }
+      file.header = readHeader(bytes);
+      file.trackData.resize(file.header->numTracks);
+    }
+    file.set.emplace(pool, options, file.trackData, file.tracks, nullptr,
+                     parseTrackData);
+    if (options.recoverChunks) {
+      for (; file.foundTracks < file.trackData.size(); ++file.foundTracks) {
+        decode(file.foundTracks);
+      }
+      return;
+    }
+  }
+  while (file.foundTracks < file.trackData.size()) {
+    // The chunk is checked against the size of the whole file, so a damaged
+    // one fails as soon as its length has arrived.
+    if (file.arrived < std::min(file.offset + CHUNK_PREFIX_SIZE,
+                                bytes.size())) {
+      return;
+    }
+    size_t offset = file.offset;
+    auto chunk = readTrackChunk(bytes, offset, file.foundTracks);
+    if (file.arrived < offset) {
+      return;
+    }
+    file.trackData[file.foundTracks] = chunk;
+    file.offset = offset;
+    decode(file.foundTracks++);
+  }
+  if (file.arrived == bytes.size()) {
+    expectEnd(bytes, file.offset);
+  }
+}
+
+}  // namespace
+
+Parser::Parser(const ParseOptions& options)
+    : Parser(ThreadPool::shared(), options) {}
+
+Parser::Parser(ThreadPool& pool, const ParseOptions& options)
+    : m_pool(&pool), m_options(options) {}
+
 MidiFile Parser::parse(const std::string& path) {
-  m_file = std::ifstream(path, std::ios::binary);
-  if(!m_file){
-    throw std::ios_base::failure("Unable to open file.");
+  auto start = statsClock();
+  readFile(path);
+  auto ioTime = statsClock() - start;
+  MidiFile file = parse(std::as_bytes(std::span(m_fileData)));
+  recordIoTime(ioTime);
+  return file;
+}
+
+MidiFile Parser::parseMapped(const std::string& path) {
+  auto start = statsClock();
+  MappedFile mapped(path);
+  auto ioTime = statsClock() - start;
+  MidiFile file = parse(mapped.bytes());
+  recordIoTime(ioTime);
+  return file;
+}
+
+std::expected<MidiFile, ParseError> Parser::tryParse(
+    const std::string& path) noexcept {
+  auto start = statsClock();
+  try {
+    readFile(path);
+  } catch (...) {
+    return std::unexpected(currentError({}));
+  }
+  auto ioTime = statsClock() - start;
+  auto file = tryParse(std::as_bytes(std::span(m_fileData)));
+  recordIoTime(ioTime);
+  return file;
+}
+
+std::expected<MidiFile, ParseError> Parser::tryParse(
+    std::span<const std::byte> data) noexcept {
+  try {
+    auto file = decodeFile(data);
+    if (!file) {
+      return std::unexpected(toParseError(file.error(), data));
+    }
+    return std::move(*file);
+  } catch (...) {
+    return std::unexpected(currentError(data));
+  }
+}
+
+MidiFile Parser::parse(std::span<const std::byte> data) {
+  auto file = decodeFile(data);
+  if (!file) {
+    throw file.error();
+  }
+  return std::move(*file);
+}
+
+std::expected<MidiFile, DecodeError> Parser::decodeFile(
+    std::span<const std::byte> data) {
+  ParseStats* stats = beginStats(data.size());
+  auto start = statsClock();
+  Header header = readTracks(data);
+  auto results = parseAllTrackData(*m_pool, m_options, header, data,
+                                   m_trackData, m_midiTracks, stats,
+                                   parseTrackData);
+  if (results.error) {
+    return std::unexpected(std::move(*results.error));
+  }
+  auto notes = fileNotes(*m_pool, m_options, m_midiTracks);
+  if (stats) {
+    stats->decodeTime = statsClock() - start;
+  }
+  return MidiFile{.fileFormat = header.fileFormat,
+                  .numTracks = header.numTracks,
+                  .tickDivision = header.tickDivision,
+                  .tracks = std::move(m_midiTracks),
+                  .tempoMap = std::move(results.tempoMap),
+                  .notes = std::move(notes),
+                  .errors = std::move(results.errors)};
+}
+
+FlatMidiFile Parser::parseFlat(const std::string& path) {
+  auto start = statsClock();
+  readFile(path);
+  auto ioTime = statsClock() - start;
+  FlatMidiFile file = parseFlat(std::as_bytes(std::span(m_fileData)));
+  recordIoTime(ioTime);
+  return file;
+}
+
+FlatMidiFile Parser::parseFlat(std::span<const std::byte> data) {
+  ParseStats* stats = beginStats(data.size());
+  auto start = statsClock();
+  Header header = readTracks(data);
+  auto results = parseAllTrackData(*m_pool, m_options, header, data,
+                                   m_trackData, m_flatTracks, stats,
+                                   parseFlatTrackData);
+  if (results.error) {
+    throw *results.error;
+  }
+  auto notes = fileNotes(*m_pool, m_options, m_flatTracks);
+  // The decoded tracks stay behind as scratch space for the next call, and
+  // the output gets exactly sized copies.
+  std::pmr::memory_resource* resource = m_options.memoryResource
+                                            ? m_options.memoryResource
+                                            : std::pmr::get_default_resource();
+  std::vector<FlatTrack> tracks;
+  tracks.reserve(m_flatTracks.size());
+  for (auto& t : m_flatTracks) {
+    const FlatTrack& copy = tracks.emplace_back(copyTrack(t, resource));
+    if (stats) {
+      for (size_t bytes : {copy.events.size() * sizeof(FlatEvent),
+                           copy.payload.size(),
+                           copy.absoluteTicks.size() * sizeof(uint64_t)}) {
+        stats->allocations += bytes > 0;
+        stats->allocatedBytes += bytes;
+      }
+    }
   }
-  readHeaderData();
-  readTrackData();
-  m_file.ignore(1);
-  if (!m_file.eof()) {
-    throw std::runtime_error(
-        "Error reading midi file. There seems to be a length mismatch.");
-  }
-  m_file.close();
-  parseAllTrackData();
-  for (auto& t : m_threadPool) {
-    t.join();
-  }
-  return MidiFile{.fileFormat = m_fileFormat,
-                  .numTracks = m_numTracks,
-                  .tickDivision = m_tickDivision,
-                  .tracks = std::move(m_midiTracks)};
-}
-
-void Parser::readHeaderData() {
-  m_file.read(reinterpret_cast<char*>(m_headerData.data()),
-              m_headerData.size());
-  m_fileFormat = 0 | (m_headerData[8] << 8) | m_headerData[9];
-  m_numTracks = 0 | (m_headerData[10] << 8) | m_headerData[11];
-  m_tickDivision = 0 | (m_headerData[12] << 8) | m_headerData[13];
-  m_trackData.resize(m_numTracks);
-  m_midiTracks.resize(m_numTracks);
-}
-
-void Parser::readTrackData() {
-  for (size_t i = 0; i < m_trackData.size(); ++i) {
-    std::array<byte, 8> metadata;
-    m_file.read(reinterpret_cast<char*>(metadata.data()), metadata.size());
-    uint32_t trackDataLength = 0 | metadata[4] << 24 | metadata[5] << 16 |
-                               metadata[6] << 8 | metadata[7];
-    auto& track = m_trackData.at(i);
-    track.resize(trackDataLength);
-    m_midiTracks.at(i).length = trackDataLength;
-    m_file.read(reinterpret_cast<char*>(track.data()), track.size());
-  }
-}
-
-void Parser::parseAllTrackData() {
-  for (size_t i = 0; i < m_trackData.size(); ++i) {
-    m_threadPool.emplace_back(std::thread(&Parser::parseTrackData, this, i));
-  }
-}
-
-std::vector<TrackEvent> Parser::parseTrackData(size_t trackIndex) {
-  auto& data = m_trackData.at(trackIndex);
-  std::vector<byte>::iterator it = data.begin();
-  auto& trackEvents = m_midiTracks.at(trackIndex).events;
-  bool endOfTrackFound = false;
-  uint8_t runningStatus = 0;
-  while (!endOfTrackFound) {
-    uint32_t deltaTime = readvlq(it);
-    uint8_t identifier = *++it;
-    switch (identifier) {
-      case 0xFF: {  // Meta Event
-        auto e = readMetaEvent(it, deltaTime);
-        if (e.status == 0x2F) {
-          endOfTrackFound = true;
+  if (stats) {
+    stats->decodeTime = statsClock() - start;
+  }
+  return FlatMidiFile{.fileFormat = header.fileFormat,
+                      .numTracks = header.numTracks,
+                      .tickDivision = header.tickDivision,
+                      .tracks = std::move(tracks),
+                      .tempoMap = std::move(results.tempoMap),
+                      .notes = std::move(notes),
+                      .errors = std::move(results.errors)};
+}
+
+ColumnarMidiFile Parser::parseColumnar(const std::string& path) {
+  auto start = statsClock();
+  readFile(path);
+  auto ioTime = statsClock() - start;
+  ColumnarMidiFile file = parseColumnar(std::as_bytes(std::span(m_fileData)));
+  recordIoTime(ioTime);
+  return file;
+}
+
+ColumnarMidiFile Parser::parseColumnar(std::span<const std::byte> data) {
+  ParseStats* stats = beginStats(data.size());
+  auto start = statsClock();
+  Header header = readTracks(data);
+  // The columns of every track are decoded separately and then copied into
+  // those of the file, which is cheap next to decoding.
+  std::vector<ColumnarTrack> tracks;
+  auto results = parseAllTrackData(*m_pool, m_options, header, data,
+                                   m_trackData, tracks, stats,
+                                   parseColumnarTrackData);
+  if (results.error) {
+    throw *results.error;
+  }
+  ColumnarMidiFile file{.fileFormat = header.fileFormat,
+                        .numTracks = header.numTracks,
+                        .tickDivision = header.tickDivision,
+                        .tempoMap = std::move(results.tempoMap),
+                        .notes = fileNotes(*m_pool, m_options, tracks),
+                        .errors = std::move(results.errors)};
+  joinColumns(tracks, file);
+  if (stats) {
+    stats->decodeTime = statsClock() - start;
+  }
+  return file;
+}
+
+std::vector<BatchResult> Parser::parseMany(
+    std::span<const std::string> paths) const {
+  return parseEach(paths);
+}
+
+std::vector<BatchResult> Parser::parseMany(
+    std::span<const std::span<const std::byte>> buffers) const {
+  return parseEach(buffers);
+}
+
+std::vector<BatchResult> Parser::parseMany(std::span<const std::string> paths,
+                                           const FileReader& reader) const {
+  std::vector<BatchResult> results(paths.size());
+  std::vector<std::unique_ptr<StreamedFile>> files(paths.size());
+  TaskGroup group(*m_pool);
+
+  auto finish = [&](size_t i) {
+    StreamedFile& file = *files[i];
+    if (file.error) {
+      results[i] = std::unexpected(file.error);
+    } else {
+      try {
+        auto trackResults = file.set->finish(*file.header, file.data);
+        if (trackResults.error) {
+          results[i] =
+              std::unexpected(std::make_exception_ptr(*trackResults.error));
+        } else {
+          auto notes = fileNotes(*m_pool, m_options, file.tracks);
+          results[i] = MidiFile{.fileFormat = file.header->fileFormat,
+                                .numTracks = file.header->numTracks,
+                                .tickDivision = file.header->tickDivision,
+                                .tracks = std::move(file.tracks),
+                                .tempoMap = std::move(trackResults.tempoMap),
+                                .notes = std::move(notes),
+                                .errors = std::move(trackResults.errors)};
         }
-        trackEvents.emplace_back(e);
-        break;
-      }
-      case 0xF0:
-      case 0xF7:  // SysEx Event
-        trackEvents.emplace_back(readSysExEvent(it, deltaTime));
-        break;
-      default:  // Midi Event
-        auto e = readMidiEvent(it, deltaTime);
-        if (e) {
-          runningStatus = identifier;
-          trackEvents.emplace_back(e.value());
-          break;
+      } catch (...) {
+        results[i] = std::unexpected(std::current_exception());
+      }
+    }
+    files[i].reset();
+  };
+  auto release = [&](size_t i) {
+    if (files[i]->pending.fetch_sub(1) == 1) {
+      finish(i);
+    }
+  };
+  auto decode = [&](size_t i, size_t track) {
+    StreamedFile& file = *files[i];
+    if (file.failed) {
+      return;
+    }
+    file.pending.fetch_add(1);
+    auto task = [&, i, track] {
+      try {
+        files[i]->set->parse(track);
+      } catch (...) {
+        files[i]->fail(std::current_exception());
+      }
+      release(i);
+    };
+    if (file.trackData[track].size() < m_options.inlineTrackThreshold) {
+      task();
+    } else {
+      group.run(task);
+    }
+  };
+
+  reader.read(
+      paths,
+      [&](size_t i, size_t size) {
+        files[i] = std::make_unique<StreamedFile>();
+        files[i]->buffer = std::make_unique_for_overwrite<std::byte[]>(size);
+        files[i]->data = {files[i]->buffer.get(), size};
+        return std::span(files[i]->buffer.get(), size);
+      },
+      [&](size_t i, size_t bytes) {
+        StreamedFile& file = *files[i];
+        file.arrived = bytes;
+        if (!file.failed) {
+          try {
+            scanArrived(file, *m_pool, m_options,
+                        [&](size_t track) { decode(i, track); });
+          } catch (...) {
+            file.fail(std::current_exception());
+          }
         }
-        e = readMidiEvent(it, deltaTime, runningStatus);
-        if (e) {
-          trackEvents.emplace_back(e.value());
-          break;
+        if (bytes == file.data.size()) {
+          release(i);
         }
-        throw std::runtime_error(
-            std::format("Unable to read or process byte: {:02X}", *it));
+      },
+      [&](size_t i, std::exception_ptr error) {
+        if (!files[i]) {
+          results[i] = std::unexpected(error);
+          return;
+        }
+        files[i]->fail(error);
+        release(i);
+      });
+  group.wait();
+  return results;
+}
+
+template <typename Input>
+std::vector<BatchResult> Parser::parseEach(
+    std::span<const Input> inputs) const {
+  std::vector<BatchResult> results(inputs.size());
+  // A file waiting for its tracks runs other queued tasks on its own stack,
+  // so queueing one task per file would nest files as deep as the batch is
+  // long. Instead, one task per worker takes the next file as it finishes
+  // one, which bounds the nesting by the size of the pool.
+  std::atomic<size_t> next = 0;
+  TaskGroup group(*m_pool);
+  for (size_t r = 0; r < std::min(inputs.size(), m_pool->size()); ++r) {
+    group.run([&] {
+      for (size_t i = next++; i < inputs.size(); i = next++) {
+        try {
+          auto file = parseStateless(*m_pool, m_options, inputs[i]);
+          if (file) {
+            results[i] = std::move(*file);
+          } else {
+            results[i] =
+                std::unexpected(std::make_exception_ptr(file.error()));
+          }
+        } catch (...) {
+          results[i] = std::unexpected(std::current_exception());
+        }
+      }
+    });
+  }
+  group.wait();
+  return results;
+}
+
+ParseStats* Parser::beginStats(size_t bytes) {
+  if constexpr (STATS_ENABLED) {
+    if (m_options.collectStats) {
+      m_stats = ParseStats{.bytesRead = bytes};
+      return &m_stats;
+    }
+  }
+  return nullptr;
+}
+
+void Parser::recordIoTime(std::chrono::nanoseconds ioTime) {
+  if constexpr (STATS_ENABLED) {
+    if (m_options.collectStats) {
+      m_stats.ioTime = ioTime;
     }
   }
-  if (it != data.end()) {
-    throw std::runtime_error(
-        "Track was marked as finished before reaching the end of the "
-        "iterator.");
+}
+
+Header Parser::readTracks(std::span<const std::byte> data) {
+  return splitChunks(data, m_trackData, m_options);
+}
+
+void Parser::readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    throw std::ios_base::failure("Unable to open file.");
   }
-  return trackEvents;
+  m_fileData.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(m_fileData.data()),
+            static_cast<std::streamsize>(m_fileData.size()));
 }
 
 }  // namespace MidiParser
@@ -1,19 +1,38 @@
 #pragma once
 
-#include <array>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <fstream>
+#include <exception>
+#include <expected>
+#include <span>
 #include <string>
-#include <thread>
 #include <vector>
 
+#include "ColumnarMidiFile.hpp"
+#include "EventHandler.hpp"
+#include "FileReader.hpp"
+#include "FlatMidiFile.hpp"
+#include "MappedFile.hpp"
 #include "MidiFile.hpp"
 #include "MidiTrack.hpp"
+#include "ParseError.hpp"
+#include "ParseOptions.hpp"
+#include "ParseStats.hpp"
+#include "ThreadPool.hpp"
+#include "chunks.hpp"
+#include "decode.hpp"
 
 namespace MidiParser {
 
 using byte = uint8_t;
 
+/**
+ * The outcome of parsing one file with `MidiParser::Parser::parseMany`:
+ * either the parsed file or the exception that parsing it threw.
+ */
+using BatchResult = std::expected<MidiFile, std::exception_ptr>;
+
 /**
  * The parser provided by MidiParser.
  *
@@ -21,11 +40,27 @@ using byte = uint8_t;
  *
  * `MidiParser::Parser parser;`
  * `MidiParser::MidiFile f = parser.parse("path/to/file.mid")`
- * 
+ *
+ * A parser keeps the buffer files are read into between calls. `parseFlat`
+ * also decodes into scratch tracks whose capacity carries over to the next
+ * call, and returns exactly sized copies of them. `parse` moves its decoded
+ * tracks into the returned `MidiParser::MidiFile` instead, so every call
+ * allocates them anew. A single instance must not parse from several threads
+ * at once. `parseMany` does not touch those buffers and may be called
+ * concurrently.
  */
 class Parser {
  public:
-  Parser() = default;
+  /**
+   * Creates a parser that decodes tracks on `MidiParser::ThreadPool::shared`.
+   */
+  explicit Parser(const ParseOptions& options = {});
+
+  /**
+   * Creates a parser that decodes tracks on `pool`, which must outlive the
+   * parser. A single pool can be shared by many parsers.
+   */
+  explicit Parser(ThreadPool& pool, const ParseOptions& options = {});
 
   /**
    * Parses the MIDI file located at `path`. Throws `std::runtime_error` if
@@ -33,23 +68,187 @@ class Parser {
    */
   MidiFile parse(const std::string& path);
 
+  /**
+   * Parses a MIDI file that is already in memory. Track chunks are decoded in
+   * place without being copied, so `data` only needs to stay alive until
+   * `parse` returns. Throws `std::runtime_error` if the data is not a valid
+   * MIDI file.
+   */
+  MidiFile parse(std::span<const std::byte> data);
+
+  /**
+   * Parses the MIDI file located at `path` like `parse`, but returns a
+   * `MidiParser::ParseError` telling what went wrong and where instead of
+   * throwing. Errors from tracks decoded on the thread pool are reported
+   * like those from any other track. Malformed tracks are passed on as
+   * values rather than exceptions internally, so a broken file costs no more
+   * than the tracks decoded before the error.
+   */
+  std::expected<MidiFile, ParseError> tryParse(
+      const std::string& path) noexcept;
+
+  /**
+   * Parses a MIDI file that is already in memory like `parse`, but returns a
+   * `MidiParser::ParseError` instead of throwing. Its `offset` is relative to
+   * the start of `data`.
+   */
+  std::expected<MidiFile, ParseError> tryParse(
+      std::span<const std::byte> data) noexcept;
+
+  /**
+   * Parses the MIDI file located at `path` by memory-mapping it instead of
+   * reading it into a buffer. Throws `std::ios_base::failure` if the file
+   * cannot be mapped and `std::runtime_error` if the MIDI file is invalid.
+   */
+  MidiFile parseMapped(const std::string& path);
+
+  /**
+   * Parses the MIDI file located at `path` into the compact
+   * `MidiParser::FlatMidiFile` representation, allocating its tracks from
+   * `ParseOptions::memoryResource`. Throws the same exceptions as `parse`.
+   */
+  FlatMidiFile parseFlat(const std::string& path);
+
+  /**
+   * Parses a MIDI file that is already in memory into the compact
+   * `MidiParser::FlatMidiFile` representation. Throws the same exceptions as
+   * `parse`.
+   */
+  FlatMidiFile parseFlat(std::span<const std::byte> data);
+
+  /**
+   * Parses the MIDI file located at `path` into columns of events, see
+   * `MidiParser::ColumnarMidiFile`. Throws the same exceptions as `parse`,
+   * and `std::length_error` if the meta and SysEx data of the file exceed
+   * 4 GiB.
+   */
+  ColumnarMidiFile parseColumnar(const std::string& path);
+
+  /**
+   * Parses a MIDI file that is already in memory into columns of events.
+   * Throws the same exceptions as the path overload.
+   */
+  ColumnarMidiFile parseColumnar(std::span<const std::byte> data);
+
+  /**
+   * Parses a MIDI file that is already in memory without storing any events,
+   * calling the hooks of `handler` (see `MidiParser::EventHandler`) with
+   * every event the options keep. Tracks are visited in order on the calling
+   * thread. Throws the same exceptions as `parse`.
+   */
+  template <typename Handler>
+  void parse(std::span<const std::byte> data, Handler& handler);
+
+  /**
+   * Parses the MIDI file located at `path` like the in-memory handler
+   * overload, memory-mapping it while it is parsed. Throws the same
+   * exceptions as `parseMapped`.
+   */
+  template <typename Handler>
+  void parse(const std::string& path, Handler& handler);
+
+  /**
+   * Parses every file in `paths`, spreading both whole files and the tracks
+   * within them over the parser's thread pool. Files are memory-mapped while
+   * they are decoded. The result at each index holds either the parsed file
+   * or the exception parsing the corresponding path threw.
+   */
+  std::vector<BatchResult> parseMany(std::span<const std::string> paths) const;
+
+  /**
+   * Parses every file in `paths` like the path overload above, but reads the
+   * files with `reader` instead of mapping them. Each track is decoded on
+   * the pool as soon as its chunk has arrived, while the rest of the file
+   * and the files after it are still being read, so that decoding overlaps
+   * with I/O on a cold page cache.
+   */
+  std::vector<BatchResult> parseMany(std::span<const std::string> paths,
+                                     const FileReader& reader) const;
+
+  /**
+   * Parses every MIDI file in `buffers` like the path overload of
+   * `parseMany`. The buffers only need to stay alive until `parseMany`
+   * returns.
+   */
+  std::vector<BatchResult> parseMany(
+      std::span<const std::span<const std::byte>> buffers) const;
+
+  /**
+   * What the last `parse`, `parseFlat` or `parseColumnar` call took, if
+   * `ParseOptions::collectStats` is set and statistics are compiled in. The
+   * handler overloads of `parse` and `parseMany` record nothing.
+   */
+  const ParseStats& stats() const { return m_stats; }
+
  private:
-  std::ifstream m_file;
-  std::vector<std::thread> m_threadPool;
+  ThreadPool* m_pool;
+  ParseOptions m_options;
 
-  std::array<byte, 14> m_headerData;
-  std::vector<std::vector<byte>> m_trackData;
+  std::vector<byte> m_fileData;
 
-  uint16_t m_fileFormat;
-  uint16_t m_numTracks;
-  uint16_t m_tickDivision;
+  std::vector<std::span<const byte>> m_trackData;
   std::vector<MidiTrack> m_midiTracks;
+  /**
+   * Tracks are decoded into these and copied out, so their capacity carries
+   * over to the next call.
+   */
+  std::vector<FlatTrack> m_flatTracks;
 
-  void readHeaderData();
-  void readTrackData();
+  ParseStats m_stats;
 
-  void parseAllTrackData();
-  std::vector<TrackEvent> parseTrackData(size_t trackIndex);
+  /**
+   * Resets `m_stats` for a parse of `bytes` bytes and returns it, or returns
+   * `nullptr` if no statistics are to be collected.
+   */
+  ParseStats* beginStats(size_t bytes);
+  void recordIoTime(std::chrono::nanoseconds ioTime);
+
+  void readFile(const std::string& path);
+  Header readTracks(std::span<const std::byte> data);
+
+  /**
+   * Parses `data` like `parse`, but returns the error of the first malformed
+   * track instead of throwing it. Damaged chunks still throw.
+   */
+  std::expected<MidiFile, DecodeError> decodeFile(
+      std::span<const std::byte> data);
+
+  template <typename Input>
+  std::vector<BatchResult> parseEach(std::span<const Input> inputs) const;
 };
 
+template <typename Handler>
+void Parser::parse(std::span<const std::byte> data, Handler& handler) {
+  Header header = readTracks(data);
+  handler.onHeader(header.fileFormat, header.numTracks, header.tickDivision);
+  for (size_t i = 0; i < m_trackData.size(); ++i) {
+    handler.onTrackBegin(i);
+    auto decoded = decodeEvents(
+        m_trackData[i], m_options, [](const EventView&, uint64_t) {},
+        [&](const EventView& e, uint64_t) {
+          switch (e.kind) {
+            case EventKind::MIDI:
+              handler.onMidiEvent(e.deltaTime, e.status, e.data);
+              break;
+            case EventKind::META:
+              handler.onMeta(e.deltaTime, e.status, e.data);
+              break;
+            case EventKind::SYSEX:
+              handler.onSysEx(e.deltaTime, e.data);
+              break;
+          }
+        });
+    if (!decoded) {
+      throwFailure(decoded.error());
+    }
+    handler.onTrackEnd(i);
+  }
+}
+
+template <typename Handler>
+void Parser::parse(const std::string& path, Handler& handler) {
+  MappedFile file(path);
+  parse(file.bytes(), handler);
+}
+
 }  // namespace MidiParser
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+#include "TrackReader.hpp"
+#include "chunks.hpp"
+#include "events.hpp"
+
+namespace MidiParser {
+
+/**
+ * An event of a `MidiParser::StaticMidiFile`.
+ */
+struct StaticEvent {
+  /**
+   * The absolute time of the event in ticks.
+   */
+  uint64_t tick;
+
+  /**
+   * The index of the event's track.
+   */
+  uint16_t track;
+
+  /**
+   * The event itself, viewing the bytes it was decoded from.
+   */
+  EventView event;
+};
+
+/**
+ * A MIDI file decoded into a table of at most `Capacity` events that lives
+ * inside the object itself, as returned by `MidiParser::decodeStatic`. Meant
+ * for short files embedded into a program as byte arrays, which can be
+ * decoded at compile time, so that they cost nothing at startup and need no
+ * heap:
+ *
+ * `static constexpr std::array<uint8_t, 42> JINGLE = {'M', 'T', 'h', ...};`
+ * `constexpr auto jingle =`
+ * `    MidiParser::decodeStatic<MidiParser::countEvents(JINGLE)>(JINGLE);`
+ *
+ * The events of all tracks are stored one track after another, in the order
+ * of the track chunks. They view the bytes they were decoded from, which must
+ * outlive the table. For a `constexpr` table, the bytes must therefore have
+ * static storage duration.
+ */
+template <size_t Capacity>
+struct StaticMidiFile {
+
+  /**
+   * The format of a MIDI file. See `MidiParser::MidiFile::fileFormat`.
+   */
+  uint16_t fileFormat = 0;
+
+  /**
+   * The number of track chunks as declared in the header chunk.
+   */
+  uint16_t numTracks = 0;
+
+  /**
+   * Unit of time used in the delta times. See
+   * `MidiParser::MidiFile::tickDivision`.
+   */
+  uint16_t tickDivision = 0;
+
+  /**
+   * The number of elements of `events` in use.
+   */
+  size_t numEvents = 0;
+
+  std::array<StaticEvent, Capacity> events{};
+
+  constexpr size_t size() const { return numEvents; }
+
+  constexpr const StaticEvent& operator[](size_t i) const { return events[i]; }
+
+  constexpr const StaticEvent* begin() const { return events.data(); }
+
+  constexpr const StaticEvent* end() const {
+    return events.data() + numEvents;
+  }
+
+  /**
+   * The events of track `track`.
+   */
+  constexpr std::span<const StaticEvent> trackEvents(uint16_t track) const {
+    auto found = std::ranges::equal_range(begin(), end(), track, {},
+                                          &StaticEvent::track);
+    return {found.begin(), found.end()};
+  }
+};
+
+/**
+ * Returns the number of events in the MIDI file `data`, which is all the
+ * capacity `decodeStatic` needs for it. Checks the file like `decodeStatic`.
+ */
+constexpr size_t countEvents(std::span<const uint8_t> data) {
+  Header header = readHeader(data);
+  size_t offset = HEADER_SIZE;
+  size_t count = 0;
+  for (size_t t = 0; t < header.numTracks; ++t) {
+    TrackReader reader(readTrackChunk(data, offset, t));
+    while (reader.next()) {
+      ++count;
+    }
+  }
+  expectEnd(data, offset);
+  return count;
+}
+
+/**
+ * Decodes the MIDI file `data` without allocating. Works in constant
+ * expressions, where a malformed file fails to compile. At run time, throws a
+ * `MidiParser::DecodeError` like `MidiParser::Parser::parse` if the file is
+ * malformed, and a `std::length_error` if it has more than `Capacity` events.
+ */
+template <size_t Capacity>
+constexpr StaticMidiFile<Capacity> decodeStatic(
+    std::span<const uint8_t> data) {
+  StaticMidiFile<Capacity> file;
+  Header header = readHeader(data);
+  file.fileFormat = header.fileFormat;
+  file.numTracks = header.numTracks;
+  file.tickDivision = header.tickDivision;
+  size_t offset = HEADER_SIZE;
+  for (uint16_t t = 0; t < header.numTracks; ++t) {
+    TrackReader reader(readTrackChunk(data, offset, t));
+    uint64_t tick = 0;
+    while (auto e = reader.next()) {
+      if (file.numEvents == Capacity) {
+        throw std::length_error("MIDI file has more events than fit.");
+      }
+      tick += e->deltaTime;
+      file.events[file.numEvents++] = {tick, t, *e};
+    }
+  }
+  expectEnd(data, offset);
+  return file;
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "TempoMap.hpp"
+
+namespace MidiParser {
+
+namespace {
+
+/**
+ * The length of one tick in seconds for an SMPTE `tickDivision`, whose upper
+ * byte holds the negated frame rate and lower byte the ticks per frame.
+ */
+double smpteSecondsPerTick(uint16_t tickDivision) {
+  int framesPerSecond = -static_cast<int8_t>(tickDivision >> 8);
+  int ticksPerFrame = tickDivision & 0xFF;
+  if (ticksPerFrame == 0) {
+    throw std::runtime_error("SMPTE tick division has zero ticks per frame.");
+  }
+  // `29` stands for 29.97 drop-frame.
+  double fps = framesPerSecond == 29 ? 30000.0 / 1001.0 : framesPerSecond;
+  return 1.0 / (fps * ticksPerFrame);
+}
+
+}  // namespace
+
+TempoMap::TempoMap(uint16_t tickDivision,
+                   const std::vector<TempoChange>& changes) {
+  if (tickDivision == 0) {
+    throw std::runtime_error("Tick division must not be zero.");
+  }
+  if (tickDivision & 0x8000) {
+    m_segments.emplace_back(0, 0.0, smpteSecondsPerTick(tickDivision));
+    return;
+  }
+  // A tempo of zero would stop time, so it is read as the fastest tempo
+  // instead.
+  auto secondsPerTick = [tickDivision](uint32_t tempo) {
+    return std::max(tempo, 1u) / 1e6 / tickDivision;
+  };
+  m_segments.emplace_back(0, 0.0, secondsPerTick(DEFAULT_TEMPO));
+  for (const TempoChange& c : changes) {
+    Segment& last = m_segments.back();
+    if (c.tick == last.tick) {
+      last.secondsPerTick = secondsPerTick(c.microsecondsPerQuarter);
+      continue;
+    }
+    double seconds = last.seconds + static_cast<double>(c.tick - last.tick) *
+                                        last.secondsPerTick;
+    m_segments.emplace_back(c.tick, seconds,
+                            secondsPerTick(c.microsecondsPerQuarter));
+  }
+}
+
+TempoMap::TempoMap(std::vector<Segment> segments)
+    : m_segments(std::move(segments)) {
+  if (m_segments.empty() || m_segments.front().tick != 0) {
+    throw std::runtime_error("Tempo map does not start at tick 0.");
+  }
+}
+
+double TempoMap::ticksToSeconds(uint64_t tick) const {
+  auto it = std::ranges::upper_bound(m_segments, tick, {}, &Segment::tick);
+  const Segment& s = *std::prev(it);
+  return s.seconds + static_cast<double>(tick - s.tick) * s.secondsPerTick;
+}
+
+uint64_t TempoMap::secondsToTicks(double seconds) const {
+  if (seconds <= 0.0) {
+    return 0;
+  }
+  auto it =
+      std::ranges::upper_bound(m_segments, seconds, {}, &Segment::seconds);
+  const Segment& s = *std::prev(it);
+  return s.tick + static_cast<uint64_t>(
+                      std::llround((seconds - s.seconds) / s.secondsPerTick));
+}
+
+}  // namespace MidiParser
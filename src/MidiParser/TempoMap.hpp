@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace MidiParser {
+
+/**
+ * A `SET_TEMPO` meta event at an absolute position in the file.
+ */
+struct TempoChange {
+  /**
+   * The absolute time of the change in ticks.
+   */
+  uint64_t tick;
+
+  /**
+   * The new tempo in microseconds per quarter note.
+   */
+  uint32_t microsecondsPerQuarter;
+
+  bool operator==(const TempoChange&) const = default;
+};
+
+/**
+ * Converts between absolute ticks and seconds for one MIDI file. Both
+ * directions are a binary search over the file's tempo changes.
+ *
+ * Example usage:
+ *
+ * `MidiParser::Parser parser({.buildTimeIndex = true});`
+ * `MidiParser::MidiFile f = parser.parse("path/to/file.mid");`
+ * `size_t i = f.tracks[1].seek(f.tempoMap->secondsToTicks(192.0));`
+ */
+class TempoMap {
+ public:
+  /**
+   * A stretch of the file played at a constant tempo.
+   */
+  struct Segment {
+    uint64_t tick;
+    double seconds;
+    double secondsPerTick;
+
+    bool operator==(const Segment&) const = default;
+  };
+
+  /**
+   * The tempo a file has until its first `SET_TEMPO` event, 120 beats per
+   * minute.
+   */
+  static constexpr uint32_t DEFAULT_TEMPO = 500000;
+
+  /**
+   * A map at the default tempo with 96 ticks per quarter note.
+   */
+  TempoMap() : TempoMap(96, {}) {}
+
+  /**
+   * Creates a map for a file with the given `tickDivision` (see
+   * `MidiParser::MidiFile::tickDivision`) from its tempo changes, which must
+   * be sorted by tick. Of several changes at the same tick, the last one
+   * wins. Tempo changes have no effect on SMPTE divisions. Throws
+   * `std::runtime_error` if `tickDivision` is `0`.
+   */
+  TempoMap(uint16_t tickDivision, const std::vector<TempoChange>& changes);
+
+  /**
+   * Restores a map from the `segments` of another one. Throws
+   * `std::runtime_error` if they are empty or do not start at tick `0`.
+   */
+  explicit TempoMap(std::vector<Segment> segments);
+
+  /**
+   * The time in seconds at which absolute tick `tick` falls.
+   */
+  double ticksToSeconds(uint64_t tick) const;
+
+  /**
+   * The absolute tick at `seconds`, rounded to the nearest tick. Times before
+   * the start of the file map to tick `0`.
+   */
+  uint64_t secondsToTicks(double seconds) const;
+
+  /**
+   * The stretches of constant tempo the map consists of, sorted by tick.
+   */
+  const std::vector<Segment>& segments() const { return m_segments; }
+
+  bool operator==(const TempoMap&) const = default;
+
+ private:
+  std::vector<Segment> m_segments;
+};
+
+}  // namespace MidiParser
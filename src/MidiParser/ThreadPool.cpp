@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "ThreadPool.hpp"
+
+namespace MidiParser {
+
+namespace {
+
+/**
+ * The pool and queue index of the worker running on this thread, so tasks
+ * submitted from inside a task stay on the worker's own queue.
+ */
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t numThreads) {
+  if (numThreads == 0) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < numThreads; ++i) {
+    m_queues.emplace_back(std::make_unique<Queue>());
+  }
+  for (size_t i = 0; i < numThreads; ++i) {
+    m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(m_sleepMutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (auto& w : m_workers) {
+    w.join();
+  }
+}
+
+ThreadPool& ThreadPool::shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::push(std::function<void()> task) {
+  size_t index = currentPool == this
+                     ? currentQueue
+                     : m_nextQueue.fetch_add(1) % m_queues.size();
+  {
+    std::lock_guard lock(m_queues[index]->mutex);
+    m_queues[index]->tasks.emplace_back(std::move(task));
+  }
+  m_queued.fetch_add(1);
+  {
+    // Taking the lock orders this notification after a sleeping worker's
+    // check of `m_queued`, so the wake-up cannot be lost.
+    std::lock_guard lock(m_sleepMutex);
+  }
+  m_wake.notify_one();
+}
+
+bool ThreadPool::tryRunOne() {
+  if (m_queued.load() == 0) {
+    return false;
+  }
+  size_t own = currentPool == this ? currentQueue : 0;
+  std::function<void()> task;
+  for (size_t i = 0; i < m_queues.size() && !task; ++i) {
+    auto& q = *m_queues[(own + i) % m_queues.size()];
+    std::lock_guard lock(q.mutex);
+    if (q.tasks.empty()) {
+      continue;
+    }
+    // Workers take the newest task from their own queue and steal the oldest
+    // one from everyone else.
+    if (i == 0 && currentPool == this) {
+      task = std::move(q.tasks.back());
+      q.tasks.pop_back();
+    } else {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  m_queued.fetch_sub(1);
+  task();
+  return true;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+  currentPool = this;
+  currentQueue = index;
+  while (true) {
+    if (tryRunOne()) {
+      continue;
+    }
+    std::unique_lock lock(m_sleepMutex);
+    m_wake.wait(lock, [this] { return m_stopping || m_queued.load() > 0; });
+    if (m_stopping && m_queued.load() == 0) {
+      return;
+    }
+  }
+}
+
+TaskGroup::~TaskGroup() {
+  try {
+    wait();
+  } catch (...) {
+  }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+  m_pending.fetch_add(1);
+  m_pool.push([this, task = std::move(task)] {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard lock(m_mutex);
+      if (!m_exception) {
+        m_exception = std::current_exception();
+      }
+    }
+    // Decrementing under the lock keeps `wait` from returning, and the group
+    // from being destroyed, before this task is done touching it.
+    std::lock_guard lock(m_mutex);
+    if (m_pending.fetch_sub(1) == 1) {
+      m_done.notify_all();
+    }
+  });
+}
+
+void TaskGroup::wait() {
+  while (m_pending.load() > 0) {
+    if (m_pool.tryRunOne()) {
+      continue;
+    }
+    // Nothing left to help with, so the remaining tasks are running on other
+    // threads. The timeout picks up tasks those may still queue.
+    std::unique_lock lock(m_mutex);
+    m_done.wait_for(lock, std::chrono::milliseconds(1),
+                    [this] { return m_pending.load() == 0; });
+  }
+  std::lock_guard lock(m_mutex);
+  if (m_exception) {
+    std::rethrow_exception(std::exchange(m_exception, nullptr));
+  }
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MidiParser {
+
+/**
+ * A fixed-size pool of worker threads. Every worker owns a task queue and
+ * steals from the other workers' queues once its own runs dry.
+ *
+ * Work is submitted through a `MidiParser::TaskGroup`. One pool can be shared
+ * by any number of `MidiParser::Parser`s and `parse` calls.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Starts `numThreads` workers. `0` starts one worker per hardware thread.
+   */
+  explicit ThreadPool(size_t numThreads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * The number of worker threads.
+   */
+  size_t size() const { return m_workers.size(); }
+
+  /**
+   * A process-wide pool with one worker per hardware thread, started on first
+   * use. Used by `MidiParser::Parser`s that are not given a pool.
+   */
+  static ThreadPool& shared();
+
+ private:
+  friend class TaskGroup;
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_workers;
+
+  std::atomic<size_t> m_queued = 0;
+  std::atomic<size_t> m_nextQueue = 0;
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+  bool m_stopping = false;
+
+  void push(std::function<void()> task);
+  bool tryRunOne();
+  void workerLoop(size_t index);
+};
+
+/**
+ * A set of tasks running on a `MidiParser::ThreadPool` that can be waited for
+ * together. The thread calling `wait` runs queued tasks itself instead of
+ * blocking, which makes it safe to wait from inside another task.
+ *
+ * Example usage:
+ *
+ * `MidiParser::TaskGroup group(pool);`
+ * `group.run([] { ... });`
+ * `group.wait();`
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool& pool) : m_pool(pool) {}
+
+  /**
+   * Waits for outstanding tasks. Exceptions thrown by them are discarded, so
+   * call `wait` explicitly to observe them.
+   */
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  /**
+   * Queues `task` to be run on the pool.
+   */
+  void run(std::function<void()> task);
+
+  /**
+   * Returns once every task queued with `run` has finished. If any task threw,
+   * the first exception is rethrown here.
+   */
+  void wait();
+
+ private:
+  ThreadPool& m_pool;
+  std::atomic<size_t> m_pending = 0;
+  std::mutex m_mutex;
+  std::condition_variable m_done;
+  std::exception_ptr m_exception;
+};
+
+}  // namespace MidiParser
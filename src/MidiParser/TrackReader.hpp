@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <iterator>
+#include <optional>
+#include <span>
+
+#include "events.hpp"
+#include "read.hpp"
+
+namespace MidiParser {
+
+/**
+ * Decodes the events of one track chunk on demand. Nothing is copied or
+ * allocated: each event is returned as a `MidiParser::EventView` into the
+ * track's bytes, so the reader uses the same small amount of memory however
+ * long the track is.
+ *
+ * Example usage:
+ *
+ * `for (MidiParser::EventView e : MidiParser::TrackReader(trackData)) { ... }`
+ *
+ * Everything but the exceptions works in constant expressions, so a malformed
+ * track decoded at compile time fails to compile.
+ */
+class TrackReader {
+ public:
+  /**
+   * Creates a reader over the data of a track chunk, i.e. the bytes following
+   * the chunk's length. `data` must outlive the reader and the views it
+   * returns.
+   */
+  constexpr explicit TrackReader(std::span<const uint8_t> data)
+      : m_it(data.data()), m_end(data.data() + data.size()) {}
+
+  /**
+   * Decodes the next event, or returns `std::nullopt` once the End of Track
+   * event has been returned. Throws a `MidiParser::DecodeError` if the track
+   * is malformed.
+   */
+  constexpr std::optional<EventView> next() {
+    auto e = tryNext();
+    if (!e) {
+      throwFailure(e.error());
+    }
+    return *e;
+  }
+
+  /**
+   * Like `next`, but returns what is wrong instead of throwing if the track
+   * is malformed. The reader must not be used any further after that.
+   */
+  constexpr std::expected<std::optional<EventView>, DecodeFailure> tryNext() {
+    if (m_done) {
+      return std::nullopt;
+    }
+    if (m_it == m_end) {
+      return std::unexpected(
+          DecodeFailure{TrackError::MISSING_END_OF_TRACK, m_it});
+    }
+    auto e = tryReadEvent(m_it, m_end, m_runningStatus);
+    if (!e) {
+      return std::unexpected(e.error());
+    }
+    if (e->kind == EventKind::META &&
+        e->status == static_cast<uint8_t>(Meta::END_OF_TRACK)) {
+      m_done = true;
+      if (m_it != m_end) {
+        return std::unexpected(
+            DecodeFailure{TrackError::DATA_AFTER_END_OF_TRACK, m_it});
+      }
+    }
+    return *e;
+  }
+
+  /**
+   * Whether the End of Track event has been read.
+   */
+  constexpr bool done() const { return m_done; }
+
+  /**
+   * The number of bytes of the track that have not been decoded yet.
+   */
+  constexpr size_t remaining() const {
+    return static_cast<size_t>(m_end - m_it);
+  }
+
+  /**
+   * The status that an event without a status byte would use next.
+   */
+  constexpr uint8_t runningStatus() const { return m_runningStatus; }
+
+  class iterator {
+   public:
+    using value_type = EventView;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    constexpr explicit iterator(TrackReader* reader) : m_reader(reader) {
+      ++*this;
+    }
+
+    constexpr const EventView& operator*() const { return m_current; }
+    constexpr const EventView* operator->() const { return &m_current; }
+
+    constexpr iterator& operator++() {
+      if (auto e = m_reader->next()) {
+        m_current = *e;
+      } else {
+        m_reader = nullptr;
+      }
+      return *this;
+    }
+    constexpr void operator++(int) { ++*this; }
+
+    constexpr bool operator==(std::default_sentinel_t) const {
+      return m_reader == nullptr;
+    }
+
+   private:
+    TrackReader* m_reader = nullptr;
+    EventView m_current{};
+  };
+
+  /**
+   * Decodes the first event not yet read and returns an iterator to it.
+   */
+  constexpr iterator begin() { return iterator(this); }
+  constexpr std::default_sentinel_t end() { return {}; }
+
+ private:
+  const uint8_t* m_it;
+  const uint8_t* m_end;
+  uint8_t m_runningStatus = 0;
+  bool m_done = false;
+};
+
+}  // namespace MidiParser
@@ -0,0 +1,238 @@
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <variant>
+
+#include "Writer.hpp"
+#include "chunks.hpp"
+#include "scan.hpp"
+
+namespace MidiParser {
+
+namespace {
+
+/**
+ * Meta and SysEx data at least this long is handed to sinks in place rather
+ * than copied into the writer's scratch buffer.
+ */
+constexpr size_t GATHER_THRESHOLD = 64;
+
+/**
+ * The largest value a variable-length quantity in a MIDI file can hold.
+ */
+constexpr uint32_t MAX_VLQ_VALUE = 0x0FFFFFFF;
+
+size_t vlqSize(uint32_t value) {
+  size_t size = 1;
+  while (value >>= 7) {
+    ++size;
+  }
+  return size;
+}
+
+/**
+ * Walks the encoding of the events of `track`, handing single bytes,
+ * variable-length quantities and data to `out`.
+ */
+template <typename Out>
+void encodeTrack(const MidiTrack& track, bool runningStatus, Out& out) {
+  uint8_t running = 0;
+  for (const TrackEvent& e : track.events) {
+    if (const auto* midi = std::get_if<MIDIEvent>(&e)) {
+      out.vlq(midi->deltaTime);
+      // Only channel messages may use running status, and only if their
+      // first data byte cannot be mistaken for a status byte.
+      bool channel = midi->status < 0xF0;
+      if (!runningStatus || midi->status != running || midi->data.empty() ||
+          midi->data[0] >= 0x80) {
+        out.byte(midi->status);
+      }
+      running = channel ? midi->status : 0;
+      out.data(midi->data);
+    } else if (const auto* meta = std::get_if<MetaEvent>(&e)) {
+      out.vlq(meta->deltaTime);
+      out.byte(0xFF);
+      out.byte(meta->status);
+      out.vlq(static_cast<uint32_t>(meta->data.size()));
+      out.data(meta->data);
+      running = 0;
+    } else {
+      const auto& sysEx = std::get<SysExEvent>(e);
+      out.vlq(sysEx.deltaTime);
+      out.byte(0xF0);
+      out.data(sysEx.data);
+      out.byte(0xF7);
+      running = 0;
+    }
+  }
+}
+
+/**
+ * Counts the bytes of an encoding and checks that it can be written.
+ */
+struct SizeCounter {
+  size_t size = 0;
+
+  void byte(uint8_t) { ++size; }
+
+  void vlq(uint32_t value) {
+    if (value > MAX_VLQ_VALUE) {
+      throw std::runtime_error(
+          "Variable-length quantity is too large to be written.");
+    }
+    size += vlqSize(value);
+  }
+
+  void data(std::span<const uint8_t> d) { size += d.size(); }
+};
+
+/**
+ * Writes an encoding into a buffer that is known to be large enough.
+ */
+struct BufferWriter {
+  uint8_t* out;
+
+  void byte(uint8_t b) { *out++ = b; }
+
+  void vlq(uint32_t value) {
+    for (size_t shift = 7 * (vlqSize(value) - 1); shift > 0; shift -= 7) {
+      *out++ = static_cast<uint8_t>((value >> shift) | 0b10000000);
+    }
+    *out++ = value & 0b01111111;
+  }
+
+  void data(std::span<const uint8_t> d) {
+    if (!d.empty()) {
+      std::memcpy(out, d.data(), d.size());
+      out += d.size();
+    }
+  }
+
+  void be16(uint16_t value) {
+    byte(static_cast<uint8_t>(value >> 8));
+    byte(static_cast<uint8_t>(value));
+  }
+
+  void be32(uint32_t value) {
+    be16(static_cast<uint16_t>(value >> 16));
+    be16(static_cast<uint16_t>(value));
+  }
+
+  void marker(const ChunkMarker& m) { data(m); }
+};
+
+/**
+ * Writes an encoding like `BufferWriter`, but leaves long data where it is
+ * and records the encoding as a list of buffers instead.
+ */
+struct GatherWriter : BufferWriter {
+  std::vector<std::span<const uint8_t>>& buffers;
+  const uint8_t* flushed;
+
+  void data(std::span<const uint8_t> d) {
+    if (d.size() < GATHER_THRESHOLD) {
+      BufferWriter::data(d);
+      return;
+    }
+    flush();
+    buffers.emplace_back(d);
+  }
+
+  void flush() {
+    if (out != flushed) {
+      buffers.emplace_back(flushed, out);
+      flushed = out;
+    }
+  }
+};
+
+uint32_t checkedTrackSize(const MidiTrack& track,
+                          const WriteOptions& options) {
+  size_t size = encodedSize(track, options);
+  if (size > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Track is too large to be written.");
+  }
+  return static_cast<uint32_t>(size);
+}
+
+void writeHeader(BufferWriter& out, const MidiFile& file) {
+  if (file.tracks.size() > std::numeric_limits<uint16_t>::max()) {
+    throw std::runtime_error("File has too many tracks to be written.");
+  }
+  out.marker(HEADER_MARKER);
+  out.be32(HEADER_SIZE - CHUNK_PREFIX_SIZE);
+  out.be16(file.fileFormat);
+  out.be16(static_cast<uint16_t>(file.tracks.size()));
+  out.be16(file.tickDivision);
+}
+
+}  // namespace
+
+size_t encodedSize(const MidiTrack& track, const WriteOptions& options) {
+  SizeCounter counter;
+  encodeTrack(track, options.runningStatus, counter);
+  return counter.size;
+}
+
+Writer::Writer(const WriteOptions& options) : m_options(options) {}
+
+std::vector<uint8_t> Writer::write(const MidiFile& file) {
+  std::vector<uint32_t> sizes;
+  sizes.reserve(file.tracks.size());
+  size_t total = HEADER_SIZE;
+  for (const auto& t : file.tracks) {
+    sizes.emplace_back(checkedTrackSize(t, m_options));
+    total += CHUNK_PREFIX_SIZE + sizes.back();
+  }
+  std::vector<uint8_t> bytes(total);
+  BufferWriter out{bytes.data()};
+  writeHeader(out, file);
+  for (size_t i = 0; i < file.tracks.size(); ++i) {
+    out.marker(TRACK_MARKER);
+    out.be32(sizes[i]);
+    encodeTrack(file.tracks[i], m_options.runningStatus, out);
+  }
+  return bytes;
+}
+
+void Writer::write(const MidiFile& file, const std::string& path) {
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  if (!stream) {
+    throw std::ios_base::failure("Unable to open file.");
+  }
+  write(file, [&](std::span<const std::span<const uint8_t>> buffers) {
+    for (auto b : buffers) {
+      stream.write(reinterpret_cast<const char*>(b.data()),
+                   static_cast<std::streamsize>(b.size()));
+    }
+  });
+  stream.flush();
+  if (!stream) {
+    throw std::ios_base::failure("Unable to write file.");
+  }
+}
+
+void Writer::write(const MidiFile& file, const WriteSink& sink) {
+  std::array<uint8_t, HEADER_SIZE> header;
+  BufferWriter headerOut{header.data()};
+  writeHeader(headerOut, file);
+  std::span<const uint8_t> headerBuffer(header);
+  sink({&headerBuffer, 1});
+  for (const auto& t : file.tracks) {
+    uint32_t size = checkedTrackSize(t, m_options);
+    // The encoding never takes more scratch space than its own size, so the
+    // buffers recorded below stay valid.
+    m_scratch.resize(CHUNK_PREFIX_SIZE + size);
+    m_buffers.clear();
+    GatherWriter out{{m_scratch.data()}, m_buffers, m_scratch.data()};
+    out.marker(TRACK_MARKER);
+    out.be32(size);
+    encodeTrack(t, m_options.runningStatus, out);
+    out.flush();
+    sink(m_buffers);
+  }
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "MidiFile.hpp"
+
+namespace MidiParser {
+
+/**
+ * Settings controlling how a `MidiParser::Writer` serializes files.
+ */
+struct WriteOptions {
+
+  /**
+   * Leave out the status byte of a channel message that repeats the previous
+   * one. Meta and SysEx events reset the running status, as the SMF
+   * specification requires.
+   */
+  bool runningStatus = true;
+};
+
+/**
+ * Receives serialized bytes as a list of buffers, to be written in order like
+ * the arguments of `writev`. The buffers are only valid during the call.
+ */
+using WriteSink =
+    std::function<void(std::span<const std::span<const uint8_t>> buffers)>;
+
+/**
+ * Serializes a `MidiParser::MidiFile` into Standard MIDI File bytes.
+ *
+ * Chunk lengths are computed in a pass over the events before anything is
+ * written, so `MidiTrack::length` is not trusted and the output never has to
+ * be patched or regrown. `numTracks` is written as the number of tracks
+ * actually present. SysEx events are written as `F0`, their data and `F7`,
+ * which is the inverse of how they are parsed.
+ *
+ * Example usage:
+ *
+ * `MidiParser::Writer writer;`
+ * `writer.write(file, "path/to/file.mid");`
+ *
+ * A writer reuses its buffers between calls, so a single instance must not be
+ * used from several threads at once.
+ */
+class Writer {
+ public:
+  explicit Writer(const WriteOptions& options = {});
+
+  /**
+   * Serializes `file` into a single buffer allocated at its final size.
+   * Throws `std::runtime_error` if a track is too large for a track chunk.
+   */
+  std::vector<uint8_t> write(const MidiFile& file);
+
+  /**
+   * Serializes `file` and writes it to `path`. Throws
+   * `std::ios_base::failure` if the file cannot be written and the same
+   * exceptions as the buffer overload otherwise.
+   */
+  void write(const MidiFile& file, const std::string& path);
+
+  /**
+   * Serializes `file` one chunk at a time into `sink`, which is called once
+   * for the header chunk and once for every track chunk. Meta and SysEx data
+   * longer than a few bytes is handed to the sink in place instead of being
+   * copied.
+   */
+  void write(const MidiFile& file, const WriteSink& sink);
+
+ private:
+  WriteOptions m_options;
+
+  std::vector<uint8_t> m_scratch;
+  std::vector<std::span<const uint8_t>> m_buffers;
+};
+
+/**
+ * The number of bytes the events of `track` take up in a track chunk written
+ * with `options`, not counting the 8 byte chunk prefix.
+ */
+size_t encodedSize(const MidiTrack& track, const WriteOptions& options = {});
+
+}  // namespace MidiParser
@@ -0,0 +1,85 @@
+#include <format>
+
+#include "ParseError.hpp"
+#include "chunks.hpp"
+
+namespace MidiParser {
+
+void throwIncompleteHeader(std::span<const uint8_t> data) {
+  throw DecodeError(ParseErrorKind::INVALID_HEADER, data.data(),
+                    "Error reading midi file. The header chunk is incomplete.");
+}
+
+void throwMissingTrack(std::span<const uint8_t> data, size_t offset,
+                       size_t trackIndex) {
+  throw DecodeError(
+      ParseErrorKind::INVALID_CHUNK, data.data() + offset,
+      std::format("Error reading midi file. Track {} is missing.", trackIndex),
+      trackIndex);
+}
+
+void throwTrackTooLong(std::span<const uint8_t> data, size_t offset,
+                       size_t trackIndex) {
+  throw DecodeError(
+      ParseErrorKind::INVALID_CHUNK, data.data() + offset,
+      std::format("Error reading midi file. Track {} exceeds the file size.",
+                  trackIndex),
+      trackIndex);
+}
+
+void throwLengthMismatch(std::span<const uint8_t> data, size_t offset) {
+  throw DecodeError(
+      ParseErrorKind::INVALID_CHUNK, data.data() + offset,
+      "Error reading midi file. There seems to be a length mismatch.");
+}
+
+Header readChunks(std::span<const uint8_t> data,
+                  std::vector<std::span<const uint8_t>>& trackData) {
+  Header header = readHeader(data);
+  trackData.resize(header.numTracks);
+  size_t offset = HEADER_SIZE;
+  for (size_t i = 0; i < trackData.size(); ++i) {
+    trackData[i] = readTrackChunk(data, offset, i);
+  }
+  expectEnd(data, offset);
+  return header;
+}
+
+Header recoverChunks(std::span<const uint8_t> data,
+                     std::vector<std::span<const uint8_t>>& trackData) {
+  auto start = findChunk(data, 0, HEADER_MARKER);
+  if (!start) {
+    throw DecodeError(ParseErrorKind::INVALID_HEADER, data.data(),
+                      "Error reading midi file. No header chunk was found.");
+  }
+  Header header = readHeader(data.subspan(*start));
+  trackData.clear();
+  size_t offset = *start + HEADER_SIZE;
+  while (trackData.size() < header.numTracks) {
+    auto chunk = findChunk(data, offset, TRACK_MARKER);
+    if (!chunk || data.size() - *chunk < CHUNK_PREFIX_SIZE) {
+      break;
+    }
+    size_t dataStart = *chunk + CHUNK_PREFIX_SIZE;
+    size_t length = readUint32(&data[*chunk + 4]);
+    if (data.size() - dataStart < length) {
+      length = findChunk(data, dataStart, TRACK_MARKER).value_or(data.size()) -
+               dataStart;
+    }
+    trackData.emplace_back(data.subspan(dataStart, length));
+    offset = dataStart + length;
+  }
+  return header;
+}
+
+std::optional<size_t> findChunk(std::span<const uint8_t> data, size_t offset,
+                                const ChunkMarker& marker) {
+  const uint8_t* end = data.data() + data.size();
+  const uint8_t* found = findMarker(data.data() + offset, end, marker);
+  if (found == end) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(found - data.data());
+}
+
+}  // namespace MidiParser
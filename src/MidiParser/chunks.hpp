@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "scan.hpp"
+
+namespace MidiParser {
+
+/**
+ * The fields of a header chunk.
+ */
+struct Header {
+  uint16_t fileFormat;
+  uint16_t numTracks;
+  uint16_t tickDivision;
+};
+
+/**
+ * The number of bytes in a header chunk, including its identifier and length.
+ */
+inline constexpr size_t HEADER_SIZE = 14;
+
+/**
+ * The number of bytes preceding the data of a track chunk.
+ */
+inline constexpr size_t CHUNK_PREFIX_SIZE = 8;
+
+/**
+ * Reads the big-endian number at `p`.
+ */
+constexpr uint16_t readUint16(const uint8_t* p) {
+  return static_cast<uint16_t>(0 | p[0] << 8 | p[1]);
+}
+
+constexpr uint32_t readUint32(const uint8_t* p) {
+  return uint32_t{p[0]} << 24 | uint32_t{p[1]} << 16 | uint32_t{p[2]} << 8 |
+         p[3];
+}
+
+/**
+ * Throw the `MidiParser::DecodeError`s of the chunk readers below. Like the
+ * event readers' errors, they are out of line and make a damaged chunk read
+ * in a constant expression fail to compile.
+ */
+[[noreturn]] void throwIncompleteHeader(std::span<const uint8_t> data);
+[[noreturn]] void throwMissingTrack(std::span<const uint8_t> data,
+                                    size_t offset, size_t trackIndex);
+[[noreturn]] void throwTrackTooLong(std::span<const uint8_t> data,
+                                    size_t offset, size_t trackIndex);
+[[noreturn]] void throwLengthMismatch(std::span<const uint8_t> data,
+                                      size_t offset);
+
+/**
+ * Reads the header chunk at the start of `data`. Throws a
+ * `MidiParser::DecodeError` if `data` is too short to hold one.
+ */
+constexpr Header readHeader(std::span<const uint8_t> data) {
+  if (data.size() < HEADER_SIZE) {
+    throwIncompleteHeader(data);
+  }
+  return Header{.fileFormat = readUint16(&data[8]),
+                .numTracks = readUint16(&data[10]),
+                .tickDivision = readUint16(&data[12])};
+}
+
+/**
+ * Reads the track chunk starting at `offset`, advances `offset` past it and
+ * returns the chunk's data. `trackIndex` is only used in error messages.
+ * Throws a `MidiParser::DecodeError` if the chunk does not fit into `data`.
+ */
+constexpr std::span<const uint8_t> readTrackChunk(
+    std::span<const uint8_t> data, size_t& offset, size_t trackIndex) {
+  if (data.size() - offset < CHUNK_PREFIX_SIZE) {
+    throwMissingTrack(data, offset, trackIndex);
+  }
+  uint32_t trackDataLength = readUint32(&data[offset + 4]);
+  if (data.size() - offset - CHUNK_PREFIX_SIZE < trackDataLength) {
+    throwTrackTooLong(data, offset, trackIndex);
+  }
+  offset += CHUNK_PREFIX_SIZE;
+  auto chunk = data.subspan(offset, trackDataLength);
+  offset += trackDataLength;
+  return chunk;
+}
+
+/**
+ * Throws a `MidiParser::DecodeError` unless `offset`, the end of the last
+ * track chunk, is the end of `data`.
+ */
+constexpr void expectEnd(std::span<const uint8_t> data, size_t offset) {
+  if (offset != data.size()) {
+    throwLengthMismatch(data, offset);
+  }
+}
+
+/**
+ * Reads the header chunk and the `numTracks` track chunks following it,
+ * pointing `trackData` at the data of each track chunk. Throws a
+ * `MidiParser::DecodeError` if a chunk does not fit into `data` or bytes are
+ * left over after the last track.
+ */
+Header readChunks(std::span<const uint8_t> data,
+                  std::vector<std::span<const uint8_t>>& trackData);
+
+/**
+ * A tolerant version of `readChunks` for damaged files. The header is searched
+ * for instead of expected at the start, so leading junk such as a RIFF
+ * wrapper is skipped. Track chunks are located by scanning for `MTrk`, which
+ * skips alien chunks and garbage between chunks, and a track whose length
+ * runs past the end of the file is cut off at the next `MTrk` or at the end.
+ * `trackData` may end up with fewer tracks than the header declares. Throws a
+ * `MidiParser::DecodeError` only if no header chunk is found.
+ */
+Header recoverChunks(std::span<const uint8_t> data,
+                     std::vector<std::span<const uint8_t>>& trackData);
+
+/**
+ * Returns the offset of the first `marker` found in `data` at or after
+ * `offset`, or `std::nullopt`.
+ */
+std::optional<size_t> findChunk(std::span<const uint8_t> data, size_t offset,
+                                const ChunkMarker& marker);
+
+}  // namespace MidiParser
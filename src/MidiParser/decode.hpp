@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <vector>
+
+#include "ParseOptions.hpp"
+#include "TrackReader.hpp"
+#include "read.hpp"
+
+namespace MidiParser {
+
+/**
+ * Decodes the events of a track chunk the way `options` ask for. `observe` is
+ * called with every decoded event and its absolute tick, and `emit` with the
+ * events the filter keeps. The delta time of an emitted event includes those
+ * of the events skipped before it. Decoding stops once the options' event or
+ * tick limit is reached. Returns the absolute tick of the last decoded event,
+ * or what is wrong if the track is malformed, in which case the events before
+ * the problem have already been passed on.
+ */
+template <typename Observe, typename Emit>
+std::expected<uint64_t, DecodeFailure> decodeEvents(
+    std::span<const uint8_t> data, const ParseOptions& options,
+    Observe&& observe, Emit&& emit) {
+  TrackReader reader(data);
+  uint64_t tick = 0;
+  uint64_t lastKept = 0;
+  size_t kept = 0;
+  while (kept < options.maxEventsPerTrack) {
+    auto next = reader.tryNext();
+    if (!next) {
+      return std::unexpected(next.error());
+    }
+    auto& e = *next;
+    if (!e) {
+      break;
+    }
+    if (tick + e->deltaTime > options.maxTick) {
+      break;
+    }
+    tick += e->deltaTime;
+    observe(*e, tick);
+    if (!options.filter.accepts(*e)) {
+      continue;
+    }
+    e->deltaTime = static_cast<uint32_t>(tick - lastKept);
+    lastKept = tick;
+    emit(*e, tick);
+    ++kept;
+  }
+  return tick;
+}
+
+/**
+ * A point between two events of a track chunk where decoding can start.
+ */
+struct SplitPoint {
+  /**
+   * The offset of the next event in the track chunk's data.
+   */
+  size_t offset;
+
+  /**
+   * The absolute tick of the event before `offset`.
+   */
+  uint64_t tick;
+
+  uint8_t runningStatus;
+};
+
+/**
+ * Steps over the events of a track chunk without copying them, validating
+ * the track like a `MidiParser::TrackReader`, and returns points to split
+ * it at, at least `segmentSize` bytes apart. The first point is the start of
+ * the track. Returns what is wrong instead if the track is malformed.
+ */
+inline std::expected<std::vector<SplitPoint>, DecodeFailure> findSplitPoints(
+    std::span<const uint8_t> data, size_t segmentSize) {
+  std::vector<SplitPoint> points = {{0, 0, 0}};
+  TrackReader reader(data);
+  uint64_t tick = 0;
+  while (true) {
+    auto next = reader.tryNext();
+    if (!next) {
+      return std::unexpected(next.error());
+    }
+    auto& e = *next;
+    if (!e) {
+      break;
+    }
+    tick += e->deltaTime;
+    size_t offset = data.size() - reader.remaining();
+    if (offset - points.back().offset >= segmentSize && !reader.done()) {
+      points.emplace_back(offset, tick, reader.runningStatus());
+    }
+  }
+  return points;
+}
+
+/**
+ * Decodes the events between `from` and the end of `data`, which must have
+ * been validated by `findSplitPoints`, like `decodeEvents` without limits.
+ * Delta times of emitted events are measured from `from.tick`. Returns the
+ * absolute tick of the last event.
+ */
+template <typename Observe, typename Emit>
+uint64_t decodeSegment(std::span<const uint8_t> data, const SplitPoint& from,
+                       const EventFilter& filter, Observe&& observe,
+                       Emit&& emit) {
+  const uint8_t* it = data.data() + from.offset;
+  const uint8_t* end = data.data() + data.size();
+  uint8_t runningStatus = from.runningStatus;
+  uint64_t tick = from.tick;
+  uint64_t lastKept = from.tick;
+  while (it != end) {
+    EventView e = readEvent(it, end, runningStatus);
+    tick += e.deltaTime;
+    observe(e, tick);
+    if (!filter.accepts(e)) {
+      continue;
+    }
+    e.deltaTime = static_cast<uint32_t>(tick - lastKept);
+    lastKept = tick;
+    emit(e, tick);
+  }
+  return tick;
+}
+
+}  // namespace MidiParser
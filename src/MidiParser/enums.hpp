@@ -1,10 +1,16 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <set>
 
 namespace MidiParser {
 
+/**
+ * The kind of a decoded track event.
+ */
+enum class EventKind : uint8_t { MIDI, META, SYSEX };
+
 enum class Meta : uint8_t {
   SEQUENCE_NUMBER = 0x00,
   TEXT = 0x01,
@@ -38,4 +44,43 @@ inline const std::set<uint8_t> DoubleByteMIDI{
     0b10000000, 0b10010000, 0b10100000, 0b11110010, 0b10110000, 0b11100000,
 };
 
+/**
+ * How a byte found where a status byte is expected is interpreted. `DATA`
+ * bytes are not status bytes at all and imply running status.
+ */
+enum class StatusKind : uint8_t { DATA, MIDI, META, SYSEX };
+
+struct StatusInfo {
+  StatusKind kind;
+
+  /**
+   * The number of data bytes following a MIDI status byte. Always `0` for
+   * other kinds.
+   */
+  uint8_t dataLength;
+};
+
+/**
+ * Classifies every possible status byte, so decoding an event needs a single
+ * table lookup. Agrees with `StatusOnlyMIDI`, `SingleByteMIDI` and
+ * `DoubleByteMIDI`.
+ */
+inline constexpr std::array<StatusInfo, 256> STATUS_TABLE = [] {
+  std::array<StatusInfo, 256> table{};
+  for (size_t status = 0x80; status < 0xF0; ++status) {
+    bool singleByte = (status & 0b11110000) == 0b11000000 ||
+                      (status & 0b11110000) == 0b11010000;
+    table[status] = {StatusKind::MIDI, uint8_t(singleByte ? 1 : 2)};
+  }
+  for (size_t status = 0xF1; status < 0xFF; ++status) {
+    table[status] = {StatusKind::MIDI, 0};
+  }
+  table[0xF2] = {StatusKind::MIDI, 2};
+  table[0xF3] = {StatusKind::MIDI, 1};
+  table[0xF0] = {StatusKind::SYSEX, 0};
+  table[0xF7] = {StatusKind::SYSEX, 0};
+  table[0xFF] = {StatusKind::META, 0};
+  return table;
+}();
+
 }  // namespace MidiParser
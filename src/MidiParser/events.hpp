@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <variant>
 #include <vector>
 
+#include "enums.hpp"
+
 namespace MidiParser {
 
 /**
@@ -22,6 +25,8 @@ struct MetaEvent {
    * the size of this vector for an event with the status `0x51` would be 3.
    */
   std::vector<uint8_t> data;
+
+  bool operator==(const MetaEvent&) const = default;
 };
 
 /**
@@ -45,6 +50,8 @@ struct MIDIEvent {
    * longer than this.
    */
   std::vector<uint8_t> data;
+
+  bool operator==(const MIDIEvent&) const = default;
 };
 
 /**
@@ -58,6 +65,8 @@ struct SysExEvent {
    * status byte and the end byte `F7`.
    */
   std::vector<uint8_t> data;
+
+  bool operator==(const SysExEvent&) const = default;
 };
 
 /**
@@ -66,4 +75,27 @@ struct SysExEvent {
  */
 using TrackEvent = std::variant<MetaEvent, MIDIEvent, SysExEvent>;
 
+/**
+ * A non-owning view of a single event. Unlike `MidiParser::TrackEvent`, the
+ * event's data is not copied and `data` points into whatever storage the
+ * view was created from.
+ */
+struct EventView {
+  uint32_t deltaTime;
+
+  EventKind kind;
+
+  /**
+   * The status byte for MIDI events, the meta type for meta events and either
+   * `F0` or `F7` for SysEx events.
+   */
+  uint8_t status;
+
+  /**
+   * The bytes following the status byte, laid out the same way as the `data`
+   * member of the corresponding owning event.
+   */
+  std::span<const uint8_t> data;
+};
+
 }  // namespace MidiParser
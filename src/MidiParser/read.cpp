@@ -1,8 +1,59 @@
+#include <format>
+#include <memory>
+#include <stdexcept>
+
 #include "read.hpp"
+#include "ParseError.hpp"
 #include "enums.hpp"
 
 namespace MidiParser {
 
+namespace {
+
+/**
+ * Runs a pointer based reader on the memory behind `it` and advances `it` by
+ * as many bytes as the reader consumed.
+ */
+template <typename Reader>
+auto throughPointer(std::vector<uint8_t>::iterator& it, Reader&& read) {
+  const uint8_t* begin = std::to_address(it);
+  const uint8_t* p = begin;
+  auto result = read(p);
+  it += p - begin;
+  return result;
+}
+
+}  // namespace
+
+DecodeError toDecodeError(const DecodeFailure& failure) {
+  switch (failure.error) {
+    case TrackError::TRUNCATED:
+      return DecodeError(ParseErrorKind::TRUNCATED_EVENT, failure.position,
+                         "Event data extends past the end of the track.");
+    case TrackError::VLQ_TOO_LONG:
+      return DecodeError(ParseErrorKind::INVALID_EVENT, failure.position,
+                         "Variable-length quantity is longer than 4 bytes.");
+    case TrackError::UNREADABLE:
+      return DecodeError(
+          ParseErrorKind::INVALID_EVENT, failure.position,
+          std::format("Unable to read or process byte: {:02X}",
+                      *failure.position));
+    case TrackError::MISSING_END_OF_TRACK:
+      return DecodeError(
+          ParseErrorKind::MISSING_END_OF_TRACK, failure.position,
+          "Track ended before an End of Track event was found.");
+    case TrackError::DATA_AFTER_END_OF_TRACK:
+      break;
+  }
+  return DecodeError(ParseErrorKind::DATA_AFTER_END_OF_TRACK, failure.position,
+                     "Track was marked as finished before reaching the end of "
+                     "the iterator.");
+}
+
+void throwFailure(const DecodeFailure& failure) {
+  throw toDecodeError(failure);
+}
+
 uint32_t vlqto32(std::stack<uint8_t>& s) {
   uint32_t out = 0;
   size_t size = s.size();
@@ -15,30 +66,25 @@ uint32_t vlqto32(std::stack<uint8_t>& s) {
 }
 
 uint32_t readvlq(std::vector<uint8_t>::iterator& it) {
-  std::stack<uint8_t> s;
-  uint8_t currByte = *it;
-  s.push(currByte);
-  while ((currByte & 0b10000000) != 0x0) {
-    currByte = *++it;
-    s.push(currByte);
-  }
-  return vlqto32(s);
+  return throughPointer(it, [](const uint8_t*& p) { return readvlq(p); });
 }
 
-MetaEvent readMetaEvent(std::vector<uint8_t>::iterator& it,
-                        uint32_t deltaTime) {
+MetaEvent readMetaEvent(const uint8_t*& it, uint32_t deltaTime) {
   uint8_t metaType = *++it;
   uint32_t length = readvlq(++it);
-  std::vector<uint8_t> data;
-  for (uint32_t i = 0; i < length; i++) {
-    data.emplace_back(*++it);
-  }
-  std::advance(it, 1);
-  return MetaEvent{.deltaTime = deltaTime, .status = metaType, .data = data};
+  std::vector<uint8_t> data(it + 1, it + 1 + length);
+  std::advance(it, length + 1);
+  return MetaEvent{
+      .deltaTime = deltaTime, .status = metaType, .data = std::move(data)};
 }
 
-SysExEvent readSysExEvent(std::vector<uint8_t>::iterator& it,
-                          uint32_t deltaTime) {
+MetaEvent readMetaEvent(std::vector<uint8_t>::iterator& it,
+                        uint32_t deltaTime) {
+  return throughPointer(
+      it, [&](const uint8_t*& p) { return readMetaEvent(p, deltaTime); });
+}
+
+SysExEvent readSysExEvent(const uint8_t*& it, uint32_t deltaTime) {
   std::vector<uint8_t> data;
   uint8_t next = *++it;
   while (next != 0xF7) {
@@ -46,50 +92,68 @@ SysExEvent readSysExEvent(std::vector<uint8_t>::iterator& it,
     next = *++it;
   }
   std::advance(it, 1);
-  return SysExEvent{.deltaTime = deltaTime, .data = data};
+  return SysExEvent{.deltaTime = deltaTime, .data = std::move(data)};
 }
 
-std::optional<MIDIEvent> readMidiEvent(std::vector<uint8_t>::iterator& it,
+SysExEvent readSysExEvent(std::vector<uint8_t>::iterator& it,
+                          uint32_t deltaTime) {
+  return throughPointer(
+      it, [&](const uint8_t*& p) { return readSysExEvent(p, deltaTime); });
+}
+
+std::optional<MIDIEvent> readMidiEvent(const uint8_t*& it,
                                        uint32_t deltaTime) {
-  if (StatusOnlyMIDI.contains(*it)) {
-    auto e = MIDIEvent{.deltaTime = deltaTime, .status = *it};
-    std::advance(it, 1);
-    return e;
+  StatusInfo info = STATUS_TABLE[*it];
+  if (info.kind != StatusKind::MIDI) {
+    return std::nullopt;
   }
-  if (SingleByteMIDI.contains(*it & 0b11110000) ||
-      SingleByteMIDI.contains(*it)) {
-    auto e = MIDIEvent{.deltaTime = deltaTime, .status = *it, .data = {*++it}};
-    std::advance(it, 1);
-    return e;
-  }
-  if (DoubleByteMIDI.contains(*it & 0b11110000) ||
-      DoubleByteMIDI.contains(*it)) {
-    auto e = MIDIEvent{
-        .deltaTime = deltaTime, .status = *it, .data = {*++it, *++it}};
-    std::advance(it, 1);
-    return e;
+  auto e = MIDIEvent{.deltaTime = deltaTime,
+                     .status = *it,
+                     .data = {it + 1, it + 1 + info.dataLength}};
+  std::advance(it, info.dataLength + 1);
+  return e;
+}
+
+std::optional<MIDIEvent> readMidiEvent(std::vector<uint8_t>::iterator& it,
+                                       uint32_t deltaTime) {
+  return throughPointer(
+      it, [&](const uint8_t*& p) { return readMidiEvent(p, deltaTime); });
+}
+
+std::optional<MIDIEvent> readMidiEvent(const uint8_t*& it, uint32_t deltaTime,
+                                       uint8_t runningStatus) {
+  StatusInfo info = STATUS_TABLE[runningStatus];
+  if (info.kind != StatusKind::MIDI || info.dataLength == 0) {
+    return std::nullopt;
   }
-  return std::nullopt;
+  auto e = MIDIEvent{.deltaTime = deltaTime,
+                     .status = runningStatus,
+                     .data = {it, it + info.dataLength}};
+  std::advance(it, info.dataLength);
+  return e;
 }
 
 std::optional<MIDIEvent> readMidiEvent(std::vector<uint8_t>::iterator& it,
                                        uint32_t deltaTime,
                                        uint8_t runningStatus) {
-  if (SingleByteMIDI.contains(runningStatus & 0b11110000) ||
-      SingleByteMIDI.contains(runningStatus)) {
-    auto e = MIDIEvent{
-        .deltaTime = deltaTime, .status = runningStatus, .data = {*it}};
-    std::advance(it, 1);
-    return e;
-  }
-  if (DoubleByteMIDI.contains(runningStatus & 0b11110000) ||
-      DoubleByteMIDI.contains(runningStatus)) {
-    auto e = MIDIEvent{
-        .deltaTime = deltaTime, .status = runningStatus, .data = {*it, *++it}};
-    std::advance(it, 1);
-    return e;
+  return throughPointer(it, [&](const uint8_t*& p) {
+    return readMidiEvent(p, deltaTime, runningStatus);
+  });
+}
+
+TrackEvent toTrackEvent(const EventView& e) {
+  std::vector<uint8_t> data(e.data.begin(), e.data.end());
+  switch (e.kind) {
+    case EventKind::META:
+      return MetaEvent{
+          .deltaTime = e.deltaTime, .status = e.status, .data = std::move(data)};
+    case EventKind::SYSEX:
+      return SysExEvent{.deltaTime = e.deltaTime, .data = std::move(data)};
+    case EventKind::MIDI:
+      break;
   }
-  return std::nullopt;
+  return MIDIEvent{
+      .deltaTime = e.deltaTime, .status = e.status, .data = std::move(data)};
 }
 
 }  // namespace MidiParser
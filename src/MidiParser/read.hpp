@@ -1,25 +1,232 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <expected>
 #include <optional>
 #include <stack>
+#include "ParseError.hpp"
+#include "enums.hpp"
 #include "events.hpp"
+#include "scan.hpp"
+#include "vlq.hpp"
 
 namespace MidiParser {
 
 uint32_t vlqto32(std::stack<uint8_t>& s);
 
+/**
+ * The readers below come in two flavours. The pointer overloads decode
+ * directly from contiguous memory such as a memory-mapped file, while the
+ * iterator overloads are kept for callers holding a `std::vector`. Both leave
+ * `it` in the same position.
+ */
+
+constexpr uint32_t readvlq(const uint8_t*& it) {
+  uint32_t out = *it & 0b01111111;
+  while ((*it & 0b10000000) != 0x0) {
+    out = out << 7 | (*++it & 0b01111111);
+  }
+  return out;
+}
+
 uint32_t readvlq(std::vector<uint8_t>::iterator& it);
 
+MetaEvent readMetaEvent(const uint8_t*& it, uint32_t deltaTime);
+
 MetaEvent readMetaEvent(std::vector<uint8_t>::iterator& it, uint32_t deltaTime);
 
+SysExEvent readSysExEvent(const uint8_t*& it, uint32_t deltaTime);
+
 SysExEvent readSysExEvent(std::vector<uint8_t>::iterator& it,
                           uint32_t deltaTime);
 
+std::optional<MIDIEvent> readMidiEvent(const uint8_t*& it, uint32_t deltaTime);
+
 std::optional<MIDIEvent> readMidiEvent(std::vector<uint8_t>::iterator& it,
                                        uint32_t deltaTime);
 
+std::optional<MIDIEvent> readMidiEvent(const uint8_t*& it, uint32_t deltaTime,
+                                       uint8_t runningStatus);
+
 std::optional<MIDIEvent> readMidiEvent(std::vector<uint8_t>::iterator& it,
                                        uint32_t deltaTime,
                                        uint8_t runningStatus);
 
+/**
+ * Why the events of a track chunk could not be decoded.
+ */
+enum class TrackError : uint8_t {
+  /**
+   * An event is cut off by the end of the track.
+   */
+  TRUNCATED,
+
+  /**
+   * A delta time or length is longer than 4 bytes.
+   */
+  VLQ_TOO_LONG,
+
+  /**
+   * A byte starts no event, e.g. a data byte without a running status.
+   */
+  UNREADABLE,
+
+  /**
+   * The track ends without an End of Track event.
+   */
+  MISSING_END_OF_TRACK,
+
+  /**
+   * The track goes on after its End of Track event.
+   */
+  DATA_AFTER_END_OF_TRACK,
+};
+
+/**
+ * A problem found by a decoder that returns its errors instead of throwing
+ * them. `position` points at the byte where it was found. Unlike a
+ * `MidiParser::DecodeError` it is cheap to create, since its message is only
+ * written once it is turned into one with `toDecodeError`.
+ */
+struct DecodeFailure {
+  TrackError error;
+  const uint8_t* position;
+};
+
+/**
+ * The `MidiParser::DecodeError` describing `failure`, and a shorthand that
+ * throws it. Kept out of line so that the readers stay small. Since they
+ * cannot run at compile time, decoding a malformed event in a constant
+ * expression with one of the throwing readers fails to compile.
+ */
+DecodeError toDecodeError(const DecodeFailure& failure);
+[[noreturn]] void throwFailure(const DecodeFailure& failure);
+
+/**
+ * Reads the delta time and body of the event starting at `it` without copying
+ * its data, then leaves `it` one past the event. Never reads at or past
+ * `end`. `runningStatus` is used for events without a status byte and
+ * updated by events with one. If no event can be read or the event is cut
+ * off by `end`, returns why and leaves `it` and `runningStatus` unchanged.
+ * Usable in constant expressions.
+ */
+constexpr std::expected<EventView, DecodeFailure> tryReadEvent(
+    const uint8_t*& it, const uint8_t* end, uint8_t& runningStatus) {
+  const uint8_t* start = it;
+  auto fail = [&](TrackError error, const uint8_t* position) {
+    it = start;
+    return std::unexpected(DecodeFailure{error, position});
+  };
+  auto truncated = [&] { return fail(TrackError::TRUNCATED, start); };
+  auto deltaTime = decodeVlq(it, end);
+  if (!deltaTime) {
+    return deltaTime.error() == VlqError::TOO_LONG
+               ? fail(TrackError::VLQ_TOO_LONG, start)
+               : truncated();
+  }
+  if (it == end) {
+    return truncated();
+  }
+  uint8_t identifier = *it;
+  StatusInfo info = STATUS_TABLE[identifier];
+  switch (info.kind) {
+    case StatusKind::META: {
+      if (end - it < 2) {
+        return truncated();
+      }
+      uint8_t metaType = it[1];
+      it += 2;
+      auto length = decodeVlq(it, end);
+      if (!length) {
+        return length.error() == VlqError::TOO_LONG
+                   ? fail(TrackError::VLQ_TOO_LONG, start)
+                   : truncated();
+      }
+      if (static_cast<size_t>(end - it) < *length) {
+        return truncated();
+      }
+      const uint8_t* data = it;
+      it += *length;
+      return EventView{*deltaTime, EventKind::META, metaType, {data, *length}};
+    }
+    case StatusKind::SYSEX: {
+      const uint8_t* data = it + 1;
+      const uint8_t* terminator;
+      if consteval {
+        terminator = std::find(data, end, uint8_t{0xF7});
+      } else {
+        terminator = findByte(data, end, 0xF7);
+      }
+      if (terminator == end) {
+        return truncated();
+      }
+      it = terminator + 1;
+      return EventView{*deltaTime, EventKind::SYSEX, identifier,
+                       {data, terminator}};
+    }
+    case StatusKind::MIDI: {
+      if (end - it <= info.dataLength) {
+        return truncated();
+      }
+      runningStatus = identifier;
+      const uint8_t* data = it + 1;
+      it += info.dataLength + 1;
+      return EventView{*deltaTime, EventKind::MIDI, identifier,
+                       {data, info.dataLength}};
+    }
+    case StatusKind::DATA:
+      break;
+  }
+  // `identifier` is already the first data byte of a running status event.
+  StatusInfo running = STATUS_TABLE[runningStatus];
+  if (running.kind != StatusKind::MIDI || running.dataLength == 0) {
+    return fail(TrackError::UNREADABLE, it);
+  }
+  if (end - it < running.dataLength) {
+    return truncated();
+  }
+  const uint8_t* data = it;
+  it += running.dataLength;
+  return EventView{*deltaTime, EventKind::MIDI, runningStatus,
+                   {data, running.dataLength}};
+}
+
+/**
+ * Like `tryReadEvent`, but throws a `MidiParser::DecodeError` if no event can
+ * be read or the event is cut off by `end`.
+ */
+constexpr EventView readEvent(const uint8_t*& it, const uint8_t* end,
+                              uint8_t& runningStatus) {
+  auto e = tryReadEvent(it, end, runningStatus);
+  if (!e) {
+    throwFailure(e.error());
+  }
+  return *e;
+}
+
+/**
+ * Like `readEvent`, but returns `std::nullopt` and leaves `it` and
+ * `runningStatus` unchanged if the event is cut off by `end`, as it may be at
+ * the end of a file that is still being written. Still throws a
+ * `MidiParser::DecodeError` if the event is malformed.
+ */
+constexpr std::optional<EventView> readCompleteEvent(const uint8_t*& it,
+                                                     const uint8_t* end,
+                                                     uint8_t& runningStatus) {
+  auto e = tryReadEvent(it, end, runningStatus);
+  if (e) {
+    return *e;
+  }
+  if (e.error().error != TrackError::TRUNCATED) {
+    throwFailure(e.error());
+  }
+  return std::nullopt;
+}
+
+/**
+ * Copies the event viewed by `e` into an owning `MidiParser::TrackEvent`.
+ */
+TrackEvent toTrackEvent(const EventView& e);
+
 }  // namespace MidiParser
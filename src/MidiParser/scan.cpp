@@ -0,0 +1,193 @@
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define MIDIPARSER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#include "scan.hpp"
+
+namespace MidiParser {
+
+namespace {
+
+bool matchesAt(const uint8_t* p, const ChunkMarker& marker) {
+  return p[0] == marker[0] && p[1] == marker[1] && p[2] == marker[2] &&
+         p[3] == marker[3];
+}
+
+#ifdef MIDIPARSER_X86
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MIDIPARSER_TARGET_SSE2 __attribute__((target("sse2")))
+#define MIDIPARSER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MIDIPARSER_TARGET_SSE2
+#define MIDIPARSER_TARGET_AVX2
+#endif
+
+MIDIPARSER_TARGET_SSE2
+const uint8_t* findByteSse2(const uint8_t* begin, const uint8_t* end,
+                            uint8_t value) {
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+  const uint8_t* p = begin;
+  for (; end - p >= 16; p += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    auto mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+    if (mask != 0) {
+      return p + std::countr_zero(mask);
+    }
+  }
+  return findByteScalar(p, end, value);
+}
+
+MIDIPARSER_TARGET_AVX2
+const uint8_t* findByteAvx2(const uint8_t* begin, const uint8_t* end,
+                            uint8_t value) {
+  const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+  const uint8_t* p = begin;
+  for (; end - p >= 32; p += 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    auto mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+    if (mask != 0) {
+      return p + std::countr_zero(mask);
+    }
+  }
+  return findByteSse2(p, end, value);
+}
+
+// The marker scanners compare the first two marker bytes against two loads
+// offset by one byte and only check the remaining two bytes of candidates.
+
+MIDIPARSER_TARGET_SSE2
+const uint8_t* findMarkerSse2(const uint8_t* begin, const uint8_t* end,
+                              const ChunkMarker& marker) {
+  const __m128i first = _mm_set1_epi8(static_cast<char>(marker[0]));
+  const __m128i second = _mm_set1_epi8(static_cast<char>(marker[1]));
+  const uint8_t* p = begin;
+  for (; end - p >= 16 + 3; p += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, second))));
+    while (mask != 0) {
+      const uint8_t* candidate = p + std::countr_zero(mask);
+      if (matchesAt(candidate, marker)) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return findMarkerScalar(p, end, marker);
+}
+
+MIDIPARSER_TARGET_AVX2
+const uint8_t* findMarkerAvx2(const uint8_t* begin, const uint8_t* end,
+                              const ChunkMarker& marker) {
+  const __m256i first = _mm256_set1_epi8(static_cast<char>(marker[0]));
+  const __m256i second = _mm256_set1_epi8(static_cast<char>(marker[1]));
+  const uint8_t* p = begin;
+  for (; end - p >= 32 + 3; p += 32) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, second))));
+    while (mask != 0) {
+      const uint8_t* candidate = p + std::countr_zero(mask);
+      if (matchesAt(candidate, marker)) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return findMarkerSse2(p, end, marker);
+}
+
+bool cpuSupportsAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  bool osSavesYmm =
+      (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0b110) == 0b110;
+  __cpuidex(info, 7, 0);
+  return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+  return false;
+#endif
+}
+
+#endif  // MIDIPARSER_X86
+
+struct Scanners {
+  const uint8_t* (*findByte)(const uint8_t*, const uint8_t*, uint8_t);
+  const uint8_t* (*findMarker)(const uint8_t*, const uint8_t*,
+                               const ChunkMarker&);
+  std::string_view name;
+};
+
+const Scanners& scanners() {
+  static const Scanners chosen = [] {
+#ifdef MIDIPARSER_X86
+    if (cpuSupportsAvx2()) {
+      return Scanners{findByteAvx2, findMarkerAvx2, "avx2"};
+    }
+    // Every x86-64 CPU has SSE2; 32-bit builds only use it when the compiler
+    // may assume it too.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    return Scanners{findByteSse2, findMarkerSse2, "sse2"};
+#endif
+#endif
+    return Scanners{findByteScalar, findMarkerScalar, "scalar"};
+  }();
+  return chosen;
+}
+
+}  // namespace
+
+const uint8_t* findByte(const uint8_t* begin, const uint8_t* end,
+                        uint8_t value) {
+  return scanners().findByte(begin, end, value);
+}
+
+const uint8_t* findMarker(const uint8_t* begin, const uint8_t* end,
+                          const ChunkMarker& marker) {
+  return scanners().findMarker(begin, end, marker);
+}
+
+const uint8_t* findByteScalar(const uint8_t* begin, const uint8_t* end,
+                              uint8_t value) {
+  for (const uint8_t* p = begin; p != end; ++p) {
+    if (*p == value) {
+      return p;
+    }
+  }
+  return end;
+}
+
+const uint8_t* findMarkerScalar(const uint8_t* begin, const uint8_t* end,
+                                const ChunkMarker& marker) {
+  for (const uint8_t* p = begin; end - p >= 4; ++p) {
+    if (matchesAt(p, marker)) {
+      return p;
+    }
+  }
+  return end;
+}
+
+std::string_view scanImplementation() {
+  return scanners().name;
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace MidiParser {
+
+/**
+ * A four byte chunk identifier such as `MThd` or `MTrk`.
+ */
+using ChunkMarker = std::array<uint8_t, 4>;
+
+inline constexpr ChunkMarker HEADER_MARKER = {'M', 'T', 'h', 'd'};
+inline constexpr ChunkMarker TRACK_MARKER = {'M', 'T', 'r', 'k'};
+
+/**
+ * Returns a pointer to the first byte in `[begin, end)` equal to `value`, or
+ * `end` if there is none. Scans 32 or 16 bytes at a time with AVX2 or SSE2,
+ * whichever the CPU supports, and falls back to `findByteScalar` otherwise.
+ */
+const uint8_t* findByte(const uint8_t* begin, const uint8_t* end,
+                        uint8_t value);
+
+/**
+ * Returns a pointer to the first occurrence of `marker` that lies entirely in
+ * `[begin, end)`, or `end` if there is none. Vectorized like `findByte`.
+ */
+const uint8_t* findMarker(const uint8_t* begin, const uint8_t* end,
+                          const ChunkMarker& marker);
+
+/**
+ * The portable, byte-at-a-time implementation of `findByte`.
+ */
+const uint8_t* findByteScalar(const uint8_t* begin, const uint8_t* end,
+                              uint8_t value);
+
+/**
+ * The portable, byte-at-a-time implementation of `findMarker`.
+ */
+const uint8_t* findMarkerScalar(const uint8_t* begin, const uint8_t* end,
+                                const ChunkMarker& marker);
+
+/**
+ * The name of the implementation `findByte` and `findMarker` dispatch to on
+ * this CPU: `"avx2"`, `"sse2"` or `"scalar"`.
+ */
+std::string_view scanImplementation();
+
+}  // namespace MidiParser
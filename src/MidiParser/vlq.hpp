@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+
+namespace MidiParser {
+
+/**
+ * Why a variable-length quantity could not be decoded.
+ */
+enum class VlqError : uint8_t {
+  /**
+   * The buffer ended before the quantity's final byte.
+   */
+  TRUNCATED,
+
+  /**
+   * The quantity is longer than the 4 bytes a MIDI file may use.
+   */
+  TOO_LONG,
+};
+
+/**
+ * The longest variable-length quantity allowed in a MIDI file, in bytes.
+ */
+inline constexpr int MAX_VLQ_BYTES = 4;
+
+/**
+ * Decodes the variable-length quantity starting at `it` without reading at or
+ * past `end`, and without allocating. On success `it` is left one past the
+ * quantity; on failure it is left unchanged.
+ */
+constexpr std::expected<uint32_t, VlqError> decodeVlq(const uint8_t*& it,
+                                                      const uint8_t* end) {
+  // Delta times and lengths almost always fit into one or two bytes. Both
+  // cases are decoded with a single branch.
+  if (end - it >= 2) {
+    uint32_t b0 = it[0];
+    uint32_t b1 = it[1];
+    if ((b0 & b1 & 0b10000000) == 0) {
+      uint32_t twoBytes = b0 >> 7;
+      it += 1 + twoBytes;
+      return (b0 & 0b01111111) << (7 * twoBytes) | (b1 & (0u - twoBytes));
+    }
+  }
+  uint32_t out = 0;
+  for (int i = 0; i < MAX_VLQ_BYTES; ++i) {
+    if (it + i == end) {
+      return std::unexpected(VlqError::TRUNCATED);
+    }
+    uint8_t currByte = it[i];
+    out = out << 7 | (currByte & 0b01111111);
+    if ((currByte & 0b10000000) == 0) {
+      it += i + 1;
+      return out;
+    }
+  }
+  return std::unexpected(VlqError::TOO_LONG);
+}
+
+}  // namespace MidiParser
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Parser.hpp"
+
+class ColumnarMidiFile : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+
+  /**
+   * Checks that `c` holds the events of `m` in track order.
+   */
+  static void expectSameEvents(const MidiParser::MidiFile& m,
+                               const MidiParser::ColumnarMidiFile& c) {
+    EXPECT_EQ(m.fileFormat, c.fileFormat);
+    EXPECT_EQ(m.numTracks, c.numTracks);
+    EXPECT_EQ(m.tickDivision, c.tickDivision);
+    ASSERT_EQ(c.trackOffsets.size(), m.tracks.size() + 1);
+    ASSERT_EQ(c.payloadOffsets.size(), c.size() + 1);
+    size_t i = 0;
+    for (size_t t = 0; t < m.tracks.size(); ++t) {
+      EXPECT_EQ(c.trackOffsets[t], i);
+      for (const auto& e : m.tracks[t].events) {
+        ASSERT_LT(i, c.size());
+        EXPECT_EQ(c.track[i], t);
+        EXPECT_EQ(c.event(i), e);
+        ++i;
+      }
+    }
+    EXPECT_EQ(c.trackOffsets.back(), i);
+    EXPECT_EQ(c.size(), i);
+  }
+};
+
+TEST_P(ColumnarMidiFile, MatchesMidiTrackEvents) {
+  MidiParser::Parser parser;
+  expectSameEvents(parser.parse(data), parser.parseColumnar(data));
+}
+
+TEST_P(ColumnarMidiFile, TicksMatchTimeIndex) {
+  MidiParser::Parser parser({.buildTimeIndex = true});
+  auto m = parser.parse(data);
+  auto c = parser.parseColumnar(data);
+  std::vector<uint64_t> ticks;
+  for (const auto& t : m.tracks) {
+    ticks.insert(ticks.end(), t.absoluteTicks.begin(), t.absoluteTicks.end());
+  }
+  EXPECT_EQ(c.tick, ticks);
+  EXPECT_EQ(c.tempoMap, m.tempoMap);
+}
+
+TEST_P(ColumnarMidiFile, AppliesFilterAndNotes) {
+  MidiParser::ParseOptions options{
+      .pairNotes = true,
+      .filter = MidiParser::EventFilter::none()
+                    .keepChannelMessages(0x90)
+                    .keepMeta(MidiParser::Meta::SET_TEMPO)};
+  MidiParser::Parser parser(options);
+  auto m = parser.parse(data);
+  auto c = parser.parseColumnar(data);
+  expectSameEvents(m, c);
+  EXPECT_EQ(c.notes, m.notes);
+}
+
+TEST_P(ColumnarMidiFile, MidiEventsHaveNoPayload) {
+  auto c = MidiParser::Parser().parseColumnar(data);
+  for (size_t i = 0; i < c.size(); ++i) {
+    if (c.kind[i] == MidiParser::EventKind::MIDI) {
+      EXPECT_TRUE(c.payloadData(i).empty());
+    } else {
+      EXPECT_EQ(c.data1[i], 0);
+      EXPECT_EQ(c.data2[i], 0);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, ColumnarMidiFile,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <ranges>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "EventFilter.hpp"
+#include "Parser.hpp"
+
+namespace {
+
+uint32_t deltaTimeOf(const MidiParser::TrackEvent& e) {
+  return std::visit([](const auto& v) { return v.deltaTime; }, e);
+}
+
+bool isNote(const MidiParser::TrackEvent& e) {
+  const auto* midi = std::get_if<MidiParser::MIDIEvent>(&e);
+  return midi && (midi->status & 0xE0) == 0x80;
+}
+
+bool isTrackName(const MidiParser::TrackEvent& e) {
+  const auto* meta = std::get_if<MidiParser::MetaEvent>(&e);
+  return meta &&
+         meta->status == static_cast<uint8_t>(MidiParser::Meta::TRACK_NAME);
+}
+
+/**
+ * The events of `track` for which `keep` holds, with their delta times
+ * adjusted to keep them at their original times.
+ */
+template <typename Keep>
+std::vector<MidiParser::TrackEvent> select(const MidiParser::MidiTrack& track,
+                                           Keep&& keep) {
+  std::vector<MidiParser::TrackEvent> out;
+  uint32_t skipped = 0;
+  for (auto e : track.events) {
+    if (!keep(e)) {
+      skipped += deltaTimeOf(e);
+      continue;
+    }
+    std::visit([&](auto& v) { v.deltaTime += skipped; }, e);
+    skipped = 0;
+    out.emplace_back(std::move(e));
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(EventFilter, AllAcceptsEveryKind) {
+  auto f = MidiParser::EventFilter::all();
+  EXPECT_TRUE(f.accepts({0, MidiParser::EventKind::MIDI, 0x93, {}}));
+  EXPECT_TRUE(f.accepts({0, MidiParser::EventKind::META, 0x51, {}}));
+  EXPECT_TRUE(f.accepts({0, MidiParser::EventKind::SYSEX, 0xF0, {}}));
+}
+
+TEST(EventFilter, KeepsChannelMessagesOnEveryChannel) {
+  auto f = MidiParser::EventFilter::none().keepChannelMessages(0x95);
+  EXPECT_TRUE(f.accepts({0, MidiParser::EventKind::MIDI, 0x90, {}}));
+  EXPECT_TRUE(f.accepts({0, MidiParser::EventKind::MIDI, 0x9F, {}}));
+  EXPECT_FALSE(f.accepts({0, MidiParser::EventKind::MIDI, 0x80, {}}));
+  EXPECT_FALSE(f.accepts({0, MidiParser::EventKind::SYSEX, 0xF0, {}}));
+}
+
+class SelectiveParse : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+  MidiParser::MidiFile full = MidiParser::Parser().parse(data);
+};
+
+TEST_P(SelectiveParse, KeepsOnlyNotesAtTheirTimes) {
+  auto notes = MidiParser::EventFilter::none()
+                   .keepChannelMessages(0x80)
+                   .keepChannelMessages(0x90);
+  auto m = MidiParser::Parser({.filter = notes}).parse(data);
+  ASSERT_EQ(m.tracks.size(), full.tracks.size());
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    EXPECT_EQ(m.tracks[i].events, select(full.tracks[i], isNote));
+  }
+}
+
+TEST_P(SelectiveParse, FlatParseAppliesFilterToo) {
+  auto names =
+      MidiParser::EventFilter::none().keepMeta(MidiParser::Meta::TRACK_NAME);
+  MidiParser::Parser parser({.filter = names});
+  auto m = parser.parse(data);
+  auto f = parser.parseFlat(data);
+  ASSERT_EQ(m.tracks.size(), f.tracks.size());
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    EXPECT_EQ(m.tracks[i].events.size(), f.tracks[i].events.size());
+    EXPECT_TRUE(std::ranges::all_of(m.tracks[i].events, isTrackName));
+  }
+}
+
+TEST_P(SelectiveParse, StopsAtMaxTick) {
+  auto m = MidiParser::Parser({.maxTick = 0}).parse(data);
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    const auto& events = full.tracks[i].events;
+    auto atStart = std::ranges::find_if(
+        events, [](const auto& e) { return deltaTimeOf(e) != 0; });
+    EXPECT_TRUE(std::ranges::equal(
+        m.tracks[i].events, std::ranges::subrange(events.begin(), atStart)));
+  }
+}
+
+TEST_P(SelectiveParse, StopsAfterMaxEvents) {
+  MidiParser::Parser parser({.buildTimeIndex = true, .maxEventsPerTrack = 3});
+  auto m = parser.parse(data);
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    const auto& events = full.tracks[i].events;
+    size_t n = std::min<size_t>(3, events.size());
+    EXPECT_TRUE(
+        std::ranges::equal(m.tracks[i].events, events | std::views::take(n)));
+    EXPECT_EQ(m.tracks[i].absoluteTicks.size(), n);
+  }
+}
+
+TEST_P(SelectiveParse, NoneKeepsNothing) {
+  auto m = MidiParser::Parser({.filter = MidiParser::EventFilter::none()})
+               .parse(data);
+  EXPECT_EQ(m.tracks.size(), full.tracks.size());
+  for (const auto& t : m.tracks) {
+    EXPECT_TRUE(t.events.empty());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, SelectiveParse,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
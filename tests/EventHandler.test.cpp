@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "EventHandler.hpp"
+#include "Parser.hpp"
+
+namespace {
+
+/**
+ * Rebuilds a `MidiFile` from the hooks it receives.
+ */
+struct Rebuilder : MidiParser::EventHandler {
+  MidiParser::MidiFile file{};
+  std::vector<size_t> begun;
+  std::vector<size_t> ended;
+
+  void onHeader(uint16_t fileFormat, uint16_t numTracks,
+                uint16_t tickDivision) {
+    file.fileFormat = fileFormat;
+    file.numTracks = numTracks;
+    file.tickDivision = tickDivision;
+  }
+
+  void onTrackBegin(size_t track) {
+    begun.emplace_back(track);
+    file.tracks.emplace_back();
+  }
+
+  void onMidiEvent(uint32_t deltaTime, uint8_t status,
+                   std::span<const uint8_t> data) {
+    file.tracks.back().events.emplace_back(MidiParser::MIDIEvent{
+        deltaTime, status, {data.begin(), data.end()}});
+  }
+
+  void onMeta(uint32_t deltaTime, uint8_t type, std::span<const uint8_t> data) {
+    file.tracks.back().events.emplace_back(
+        MidiParser::MetaEvent{deltaTime, type, {data.begin(), data.end()}});
+  }
+
+  void onSysEx(uint32_t deltaTime, std::span<const uint8_t> data) {
+    file.tracks.back().events.emplace_back(
+        MidiParser::SysExEvent{deltaTime, {data.begin(), data.end()}});
+  }
+
+  void onTrackEnd(size_t track) { ended.emplace_back(track); }
+};
+
+/**
+ * Only implements one hook and relies on the defaults for the rest.
+ */
+struct NoteCounter : MidiParser::EventHandler {
+  size_t notes = 0;
+
+  void onMidiEvent(uint32_t, uint8_t status, std::span<const uint8_t>) {
+    notes += (status & 0xF0) == 0x90;
+  }
+};
+
+}  // namespace
+
+class EventHandler : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(EventHandler, ReceivesEveryEventInOrder) {
+  auto m = MidiParser::Parser().parse(data);
+  Rebuilder r;
+  MidiParser::Parser().parse(data, r);
+  ASSERT_EQ(r.file.tracks.size(), m.tracks.size());
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    EXPECT_EQ(r.file.tracks[i].events, m.tracks[i].events);
+    EXPECT_EQ(r.begun[i], i);
+    EXPECT_EQ(r.ended[i], i);
+  }
+  EXPECT_EQ(r.file.fileFormat, m.fileFormat);
+  EXPECT_EQ(r.file.numTracks, m.numTracks);
+  EXPECT_EQ(r.file.tickDivision, m.tickDivision);
+}
+
+TEST_P(EventHandler, AppliesParseOptions) {
+  auto notes = MidiParser::EventFilter::none().keepChannelMessages(0x90);
+  MidiParser::Parser parser({.filter = notes, .maxEventsPerTrack = 10});
+  auto m = parser.parse(data);
+  Rebuilder r;
+  parser.parse(data, r);
+  ASSERT_EQ(r.file.tracks.size(), m.tracks.size());
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    EXPECT_EQ(r.file.tracks[i].events, m.tracks[i].events);
+  }
+}
+
+TEST_P(EventHandler, HandlersMayImplementSomeHooks) {
+  auto m = MidiParser::Parser().parse(data);
+  size_t expected = 0;
+  for (const auto& t : m.tracks) {
+    for (const auto& e : t.events) {
+      const auto* midi = std::get_if<MidiParser::MIDIEvent>(&e);
+      expected += midi && (midi->status & 0xF0) == 0x90;
+    }
+  }
+  NoteCounter counter;
+  MidiParser::Parser().parse(data, counter);
+  EXPECT_EQ(counter.notes, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, EventHandler,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(EventHandlerErrors, TruncatedFileThrows) {
+  std::vector<std::byte> data(10);
+  NoteCounter counter;
+  EXPECT_THROW(MidiParser::Parser().parse(std::span(data), counter),
+               std::runtime_error);
+}
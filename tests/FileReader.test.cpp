@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "FileReader.hpp"
+
+namespace {
+
+/**
+ * Writes `size` bytes counting up from `seed` to a temporary file and
+ * returns its path.
+ */
+std::string writeFile(const std::string& name, size_t size, uint8_t seed) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::vector<char> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<char>(seed + i);
+  }
+  std::ofstream(path, std::ios::binary)
+      .write(bytes.data(), static_cast<std::streamsize>(size));
+  return path.string();
+}
+
+}  // namespace
+
+class FileReader : public testing::TestWithParam<bool> {
+ public:
+  /**
+   * Small blocks and queues, so that files take several reads each and
+   * wait for each other.
+   */
+  MidiParser::FileReaderOptions options{.queueDepth = 3,
+                                        .blockSize = 4096,
+                                        .maxOpenFiles = 2,
+                                        .useIoUring = GetParam(),
+                                        .ioThreads = 2};
+};
+
+TEST_P(FileReader, ReadsEveryFileCompletelyInOrder) {
+  std::vector<size_t> sizes = {0, 1, 4095, 4096, 3 * 4096 + 5, 100000};
+  std::vector<std::string> paths;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    paths.emplace_back(writeFile(std::format("MidiParserReader{}", i),
+                                 sizes[i], static_cast<uint8_t>(i)));
+  }
+  std::vector<std::vector<std::byte>> buffers(paths.size());
+  std::vector<size_t> arrived(paths.size());
+  std::vector<size_t> opened;
+  MidiParser::FileReader reader(options);
+  reader.read(
+      paths,
+      [&](size_t i, size_t size) {
+        opened.emplace_back(i);
+        buffers[i].resize(size);
+        return std::span(buffers[i]);
+      },
+      [&](size_t i, size_t bytes) {
+        EXPECT_TRUE(bytes > arrived[i] || bytes == 0);
+        arrived[i] = bytes;
+      },
+      [](size_t, std::exception_ptr) { FAIL(); });
+  EXPECT_EQ(opened, (std::vector<size_t>{0, 1, 2, 3, 4, 5}));
+  for (size_t i = 0; i < paths.size(); ++i) {
+    EXPECT_EQ(arrived[i], sizes[i]);
+    std::ifstream file(paths[i], std::ios::binary);
+    std::vector<char> expected(std::istreambuf_iterator<char>(file), {});
+    EXPECT_EQ(std::as_bytes(std::span(expected)).size(), buffers[i].size());
+    EXPECT_TRUE(std::ranges::equal(std::as_bytes(std::span(expected)),
+                                   buffers[i]));
+    std::filesystem::remove(paths[i]);
+  }
+}
+
+TEST_P(FileReader, ReportsFilesThatCannotBeOpened) {
+  std::vector<std::string> paths = {writeFile("MidiParserReaderA", 10, 0),
+                                    "does not exist",
+                                    writeFile("MidiParserReaderB", 10, 0)};
+  std::vector<std::byte> buffer(10);
+  std::vector<size_t> completed;
+  std::vector<size_t> failed;
+  MidiParser::FileReader(options).read(
+      paths, [&](size_t, size_t) { return std::span(buffer); },
+      [&](size_t i, size_t bytes) {
+        if (bytes == 10) {
+          completed.emplace_back(i);
+        }
+      },
+      [&](size_t i, std::exception_ptr error) {
+        failed.emplace_back(i);
+        EXPECT_THROW(std::rethrow_exception(error), std::ios_base::failure);
+      });
+  EXPECT_EQ(completed, (std::vector<size_t>{0, 2}));
+  EXPECT_EQ(failed, (std::vector<size_t>{1}));
+  std::filesystem::remove(paths[0]);
+  std::filesystem::remove(paths[2]);
+}
+
+TEST_P(FileReader, ReportsFailedOpenCallback) {
+  std::vector<std::string> paths = {writeFile("MidiParserReaderC", 10, 0)};
+  bool failed = false;
+  MidiParser::FileReader(options).read(
+      paths,
+      [](size_t, size_t) -> std::span<std::byte> {
+        throw std::bad_alloc();
+      },
+      [](size_t, size_t) { FAIL(); },
+      [&](size_t, std::exception_ptr) { failed = true; });
+  EXPECT_TRUE(failed);
+  std::filesystem::remove(paths[0]);
+}
+
+TEST(FileReaderBackend, ThreadsWhenIoUringIsOff) {
+  MidiParser::FileReader reader({.useIoUring = false});
+  EXPECT_EQ(reader.backend(), MidiParser::FileReader::Backend::THREADS);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Backends, FileReader, testing::Bool(),
+    [](const testing::TestParamInfo<bool>& info) {
+      return info.param ? "IoUring" : "Threads";
+    });
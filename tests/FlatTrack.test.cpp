@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <variant>
+
+#include "Parser.hpp"
+#include "read.hpp"
+
+namespace {
+
+bool sameEvent(const MidiParser::TrackEvent& a,
+               const MidiParser::EventView& b) {
+  return a == MidiParser::toTrackEvent(b);
+}
+
+}  // namespace
+
+class FlatTrack : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(FlatTrack, MatchesMidiTrackEvents) {
+  auto m = MidiParser::Parser().parse(data);
+  auto f = MidiParser::Parser().parseFlat(data);
+  EXPECT_EQ(m.fileFormat, f.fileFormat);
+  EXPECT_EQ(m.numTracks, f.numTracks);
+  EXPECT_EQ(m.tickDivision, f.tickDivision);
+  ASSERT_EQ(m.tracks.size(), f.tracks.size());
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    const auto& events = m.tracks[i].events;
+    const auto& flat = f.tracks[i];
+    EXPECT_EQ(m.tracks[i].length, flat.length);
+    ASSERT_EQ(events.size(), flat.events.size());
+    for (size_t j = 0; j < events.size(); ++j) {
+      EXPECT_TRUE(sameEvent(events[j], flat.view(j)));
+    }
+  }
+}
+
+TEST_P(FlatTrack, ViewsVisitEveryEvent) {
+  auto f = MidiParser::Parser().parseFlat(data);
+  for (const auto& t : f.tracks) {
+    size_t n = 0;
+    for (MidiParser::EventView e : t.views()) {
+      EXPECT_EQ(e.deltaTime, t.events[n++].deltaTime);
+    }
+    EXPECT_EQ(n, t.events.size());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, FlatTrack,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(FlatTrackAppend, StoresMidiDataInline) {
+  MidiParser::FlatTrack t{};
+  uint8_t data[] = {60, 100};
+  t.append({.deltaTime = 5,
+            .kind = MidiParser::EventKind::MIDI,
+            .status = 0x90,
+            .data = data});
+  EXPECT_TRUE(t.payload.empty());
+  auto e = t.view(0);
+  EXPECT_EQ(e.deltaTime, 5);
+  EXPECT_EQ(e.status, 0x90);
+  ASSERT_EQ(e.data.size(), 2);
+  EXPECT_EQ(e.data[0], 60);
+  EXPECT_EQ(e.data[1], 100);
+}
+
+TEST(FlatTrackAppend, StoresMetaDataInPayload) {
+  MidiParser::FlatTrack t{};
+  uint8_t tempo[] = {0x07, 0xA1, 0x20};
+  uint8_t name[] = {'p', 'i', 'a', 'n', 'o'};
+  t.append({0, MidiParser::EventKind::META, 0x51, tempo});
+  t.append({0, MidiParser::EventKind::META, 0x03, name});
+  EXPECT_EQ(t.payload.size(), 8);
+  auto e = t.view(1);
+  EXPECT_EQ(e.kind, MidiParser::EventKind::META);
+  EXPECT_EQ(std::string(e.data.begin(), e.data.end()), "piano");
+}
+
+namespace {
+
+/**
+ * Counts the bytes allocated through it and forwards to the default resource.
+ */
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    allocated += bytes;
+    return std::pmr::get_default_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+}  // namespace
+
+TEST_P(FlatTrack, AllocatesFromMemoryResource) {
+  CountingResource resource;
+  auto f = MidiParser::Parser({.buildTimeIndex = true,
+                               .memoryResource = &resource})
+               .parseFlat(data);
+  size_t expected = 0;
+  for (const auto& t : f.tracks) {
+    EXPECT_EQ(t.events.get_allocator().resource(), &resource);
+    EXPECT_EQ(t.payload.get_allocator().resource(), &resource);
+    EXPECT_EQ(t.absoluteTicks.get_allocator().resource(), &resource);
+    // Every buffer is allocated once, at its final size.
+    EXPECT_EQ(t.events.capacity(), t.events.size());
+    expected += t.events.size() * sizeof(MidiParser::FlatEvent) +
+                t.payload.size() + t.absoluteTicks.size() * sizeof(uint64_t);
+  }
+  EXPECT_EQ(resource.allocated, expected);
+  EXPECT_EQ(f, MidiParser::Parser({.buildTimeIndex = true}).parseFlat(data));
+}
+
+TEST_P(FlatTrack, EarlierOutputSurvivesReuse) {
+  std::pmr::monotonic_buffer_resource arena;
+  MidiParser::Parser parser({.memoryResource = &arena});
+  auto first = parser.parseFlat(data);
+  parser.parseFlat(std::string(EXAMPLES_DIR) + "/cmaj.mid");
+  EXPECT_EQ(first, MidiParser::Parser().parseFlat(data));
+}
+
+TEST(ReusedParser, MatchesFreshParserForEveryFile) {
+  MidiParser::Parser reused({.buildTimeIndex = true});
+  for (std::string name :
+       {"mahler", "cmaj", "debussy", "twinkle", "queen", "mozart", "cmaj"}) {
+    auto path = std::string(EXAMPLES_DIR) + "/" + name + ".mid";
+    MidiParser::Parser fresh({.buildTimeIndex = true});
+    EXPECT_EQ(reused.parse(path), fresh.parse(path));
+    EXPECT_EQ(reused.parseFlat(path), fresh.parseFlat(path));
+  }
+}
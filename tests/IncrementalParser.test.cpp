@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "IncrementalParser.hpp"
+#include "Parser.hpp"
+
+namespace {
+
+std::vector<uint8_t> readBytes(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), {}};
+}
+
+/**
+ * Feeds `bytes` to `parser` `step` bytes at a time, as if it were being
+ * recorded, and returns the total number of events added.
+ */
+size_t feed(MidiParser::IncrementalParser& parser,
+            const std::vector<uint8_t>& bytes, size_t step) {
+  size_t added = 0;
+  for (size_t size = 0; size < bytes.size();) {
+    size = std::min(size + step, bytes.size());
+    added += parser.update(std::as_bytes(std::span(bytes).first(size)));
+  }
+  return added;
+}
+
+void expectSameFile(const MidiParser::MidiFile& a,
+                    const MidiParser::MidiFile& b) {
+  EXPECT_EQ(a.fileFormat, b.fileFormat);
+  EXPECT_EQ(a.numTracks, b.numTracks);
+  EXPECT_EQ(a.tickDivision, b.tickDivision);
+  EXPECT_EQ(a.tracks, b.tracks);
+  EXPECT_EQ(a.tempoMap, b.tempoMap);
+}
+
+void setLength(std::vector<uint8_t>& bytes, size_t chunk, uint32_t length) {
+  for (int b = 0; b < 4; ++b) {
+    bytes[chunk + 4 + b] = static_cast<uint8_t>(length >> (24 - 8 * b));
+  }
+}
+
+/**
+ * Returns `bytes` with every track length left at 0, as a recorder writes
+ * them until it closes the file.
+ */
+std::vector<uint8_t> withPlaceholderLengths(std::vector<uint8_t> bytes) {
+  std::vector<size_t> chunks;
+  for (size_t offset = MidiParser::HEADER_SIZE; offset < bytes.size();) {
+    chunks.emplace_back(offset);
+    offset += MidiParser::CHUNK_PREFIX_SIZE +
+              (bytes[offset + 4] << 24 | bytes[offset + 5] << 16 |
+               bytes[offset + 6] << 8 | bytes[offset + 7]);
+  }
+  for (size_t chunk : chunks) {
+    setLength(bytes, chunk, 0);
+  }
+  return bytes;
+}
+
+}  // namespace
+
+class Incremental : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(Incremental, AppendedBytesGiveSameFile) {
+  auto bytes = readBytes(data);
+  auto expected = MidiParser::Parser().parse(data);
+  for (size_t step : {1, 7, 1000}) {
+    if (step == 1 && bytes.size() > 20000) {
+      continue;
+    }
+    MidiParser::IncrementalParser parser;
+    size_t added = feed(parser, bytes, step);
+    EXPECT_TRUE(parser.complete());
+    expectSameFile(parser.file(), expected);
+    size_t events = 0;
+    for (const auto& t : expected.tracks) {
+      events += t.events.size();
+    }
+    EXPECT_EQ(added, events);
+  }
+}
+
+TEST_P(Incremental, OptionsApplyAcrossUpdates) {
+  MidiParser::ParseOptions options{
+      .buildTimeIndex = true,
+      .filter = MidiParser::EventFilter::none()
+                    .keepChannelMessages(0x90)
+                    .keepMeta(MidiParser::Meta::END_OF_TRACK),
+      .maxEventsPerTrack = 300};
+  MidiParser::IncrementalParser parser(options);
+  feed(parser, readBytes(data), 333);
+  EXPECT_TRUE(parser.complete());
+  expectSameFile(parser.file(), MidiParser::Parser(options).parse(data));
+}
+
+TEST_P(Incremental, PlaceholderLengthsAreOpen) {
+  MidiParser::IncrementalParser parser;
+  feed(parser, withPlaceholderLengths(readBytes(data)), 500);
+  EXPECT_TRUE(parser.complete());
+  auto expected = MidiParser::Parser().parse(data);
+  ASSERT_EQ(parser.file().tracks.size(), expected.tracks.size());
+  for (size_t i = 0; i < expected.tracks.size(); ++i) {
+    EXPECT_EQ(parser.file().tracks[i].events, expected.tracks[i].events);
+  }
+}
+
+// A track cut short by a limit must still be stepped over to its End of
+// Track event, the only way to find the next track.
+TEST_P(Incremental, PlaceholderLengthsAreOpenWithEventLimit) {
+  MidiParser::ParseOptions options{.maxEventsPerTrack = 5};
+  MidiParser::IncrementalParser parser(options);
+  feed(parser, withPlaceholderLengths(readBytes(data)), 500);
+  EXPECT_TRUE(parser.complete());
+  auto expected = MidiParser::Parser(options).parse(data);
+  ASSERT_EQ(parser.file().tracks.size(), expected.tracks.size());
+  for (size_t i = 0; i < expected.tracks.size(); ++i) {
+    EXPECT_EQ(parser.file().tracks[i].events, expected.tracks[i].events);
+  }
+}
+
+TEST_P(Incremental, PlaceholderLengthsAreOpenWithTickLimit) {
+  MidiParser::ParseOptions options{.maxTick = 1000};
+  MidiParser::IncrementalParser parser(options);
+  feed(parser, withPlaceholderLengths(readBytes(data)), 500);
+  EXPECT_TRUE(parser.complete());
+  auto expected = MidiParser::Parser(options).parse(data);
+  ASSERT_EQ(parser.file().tracks.size(), expected.tracks.size());
+  for (size_t i = 0; i < expected.tracks.size(); ++i) {
+    EXPECT_EQ(parser.file().tracks[i].events, expected.tracks[i].events);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, Incremental,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(IncrementalParser, NothingNewAddsNothing) {
+  auto bytes = readBytes(std::string(EXAMPLES_DIR) + "/twinkle.mid");
+  MidiParser::IncrementalParser parser;
+  auto half = std::as_bytes(std::span(bytes).first(bytes.size() / 2));
+  size_t added = parser.update(half);
+  EXPECT_GT(added, 0);
+  EXPECT_FALSE(parser.complete());
+  EXPECT_EQ(parser.update(half), 0);
+  EXPECT_THROW(parser.update(std::as_bytes(std::span(bytes).first(10))),
+               std::invalid_argument);
+}
+
+TEST(IncrementalParser, TrailingBytesAreNotAnError) {
+  auto bytes = readBytes(std::string(EXAMPLES_DIR) + "/cmaj.mid");
+  bytes.insert(bytes.end(), {'M', 'T', 'r'});
+  MidiParser::IncrementalParser parser;
+  parser.update(std::as_bytes(std::span(bytes)));
+  EXPECT_TRUE(parser.complete());
+}
+
+TEST(IncrementalParser, ClosedTrackWithoutEndThrows) {
+  std::vector<uint8_t> bytes = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1,
+                                0, 96, 'M', 'T', 'r', 'k', 0, 0, 0, 4,
+                                0, 0x90, 60, 100};
+  MidiParser::IncrementalParser parser;
+  EXPECT_THROW(parser.update(std::as_bytes(std::span(bytes))),
+               std::runtime_error);
+}
+
+TEST(IncrementalParser, ReadsOnlyAppendedFileBytes) {
+  auto bytes = readBytes(std::string(EXAMPLES_DIR) + "/queen.mid");
+  auto path =
+      std::filesystem::temp_directory_path() / "MidiParserIncremental.mid";
+  MidiParser::IncrementalParser parser;
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (size_t i = 0; i < bytes.size(); i += 4096) {
+      size_t n = std::min<size_t>(4096, bytes.size() - i);
+      out.write(reinterpret_cast<const char*>(bytes.data() + i),
+                static_cast<std::streamsize>(n));
+      out.flush();
+      parser.update(path.string());
+    }
+  }
+  EXPECT_TRUE(parser.complete());
+  expectSameFile(parser.file(),
+                 MidiParser::Parser().parse(std::as_bytes(std::span(bytes))));
+
+  // A shorter file was rewritten and is parsed from the start.
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char*>(bytes.data()), 100);
+  parser.update(path.string());
+  EXPECT_FALSE(parser.complete());
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "MergedTracks.hpp"
+#include "Parser.hpp"
+
+namespace {
+
+MidiParser::TrackEvent noteOn(uint32_t deltaTime, uint8_t key) {
+  return MidiParser::MIDIEvent{
+      .deltaTime = deltaTime, .status = 0x90, .data = {key, 100}};
+}
+
+MidiParser::TrackEvent endOfTrack(uint32_t deltaTime) {
+  return MidiParser::MetaEvent{
+      .deltaTime = deltaTime,
+      .status = static_cast<uint8_t>(MidiParser::Meta::END_OF_TRACK),
+      .data = {}};
+}
+
+MidiParser::MidiFile twoTracks() {
+  MidiParser::MidiFile f{.fileFormat = 1, .numTracks = 2, .tickDivision = 96};
+  f.tracks.resize(2);
+  f.tracks[0].events = {noteOn(0, 60), noteOn(10, 61), endOfTrack(5)};
+  f.tracks[1].events = {noteOn(10, 70), noteOn(0, 71), endOfTrack(20)};
+  return f;
+}
+
+uint8_t keyOf(const MidiParser::TrackEvent& e) {
+  return std::get<MidiParser::MIDIEvent>(e).data[0];
+}
+
+}  // namespace
+
+TEST(MergedTracks, OrdersByTickThenTrack) {
+  auto f = twoTracks();
+  std::vector<uint64_t> ticks;
+  std::vector<size_t> tracks;
+  for (MidiParser::MergedEvent e : MidiParser::MergedTracks(f)) {
+    ticks.emplace_back(e.tick);
+    tracks.emplace_back(e.track);
+  }
+  EXPECT_EQ(ticks, (std::vector<uint64_t>{0, 10, 10, 10, 15, 30}));
+  EXPECT_EQ(tracks, (std::vector<size_t>{0, 0, 1, 1, 0, 1}));
+}
+
+TEST(MergedTracks, ReturnsNothingForEmptyFile) {
+  MidiParser::MidiFile f{};
+  MidiParser::MergedTracks merged(f);
+  EXPECT_TRUE(merged.done());
+  EXPECT_FALSE(merged.next());
+}
+
+TEST(FlattenToFormat0, RewritesDeltaTimesAndEndOfTrack) {
+  auto flat = MidiParser::flattenToFormat0(twoTracks());
+  EXPECT_EQ(flat.fileFormat, 0);
+  EXPECT_EQ(flat.numTracks, 1);
+  ASSERT_EQ(flat.tracks.size(), 1);
+  const auto& events = flat.tracks[0].events;
+  ASSERT_EQ(events.size(), 5);
+  EXPECT_EQ(keyOf(events[0]), 60);
+  EXPECT_EQ(keyOf(events[1]), 61);
+  EXPECT_EQ(keyOf(events[2]), 70);
+  EXPECT_EQ(keyOf(events[3]), 71);
+  std::vector<uint32_t> deltas;
+  for (const auto& e : events) {
+    deltas.emplace_back(
+        std::visit([](const auto& v) { return v.deltaTime; }, e));
+  }
+  EXPECT_EQ(deltas, (std::vector<uint32_t>{0, 10, 0, 0, 20}));
+  EXPECT_EQ(events.back(), endOfTrack(20));
+  // A note on of 4 bytes, three of 3 bytes using running status and an End
+  // of Track event of 4 bytes.
+  EXPECT_EQ(flat.tracks[0].length, 17);
+}
+
+class Flatten : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(Flatten, KeepsEveryEventAtItsTime) {
+  MidiParser::Parser parser({.buildTimeIndex = true});
+  auto m = parser.parse(data);
+  auto flat = MidiParser::flattenToFormat0(m);
+  ASSERT_EQ(flat.tracks.size(), 1);
+  const auto& t = flat.tracks[0];
+  EXPECT_EQ(t.events.size(), t.absoluteTicks.size());
+  EXPECT_TRUE(std::ranges::is_sorted(t.absoluteTicks));
+
+  size_t numEvents = 0;
+  uint64_t endTick = 0;
+  for (const auto& track : m.tracks) {
+    numEvents += track.events.size();
+    endTick = std::max(endTick, track.absoluteTicks.back());
+  }
+  EXPECT_EQ(t.events.size(), numEvents - m.tracks.size() + 1);
+  EXPECT_EQ(t.absoluteTicks.back(), endTick);
+}
+
+TEST_P(Flatten, IsIdempotent) {
+  auto m = MidiParser::Parser().parse(data);
+  auto flat = MidiParser::flattenToFormat0(m);
+  EXPECT_EQ(MidiParser::flattenToFormat0(flat), flat);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, Flatten,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
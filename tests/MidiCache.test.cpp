@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include "MidiCache.hpp"
+#include "Parser.hpp"
+
+namespace {
+
+std::string cachePath(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / (name + ".midicache"))
+      .string();
+}
+
+}  // namespace
+
+class MidiCache : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+  std::string cache = cachePath(GetParam());
+
+  void TearDown() override { std::filesystem::remove(cache); }
+};
+
+TEST_P(MidiCache, RoundTripsFlatMidiFile) {
+  auto f = MidiParser::Parser().parseFlat(data);
+  MidiParser::writeCache(f, 42, cache);
+  MidiParser::CachedMidiFile c(cache);
+  EXPECT_EQ(c.sourceHash(), 42);
+  EXPECT_EQ(c.fileFormat(), f.fileFormat);
+  EXPECT_EQ(c.numTracks(), f.numTracks);
+  EXPECT_EQ(c.tickDivision(), f.tickDivision);
+  EXPECT_FALSE(c.tempoMap());
+  EXPECT_EQ(c.toFlatMidiFile(), f);
+}
+
+TEST_P(MidiCache, RoundTripsTimeIndex) {
+  auto f = MidiParser::Parser({.buildTimeIndex = true}).parseFlat(data);
+  MidiParser::writeCache(f, 0, cache);
+  MidiParser::CachedMidiFile c(cache);
+  ASSERT_TRUE(c.tempoMap());
+  EXPECT_EQ(*c.tempoMap(), *f.tempoMap);
+  for (size_t i = 0; i < f.tracks.size(); ++i) {
+    const auto& t = c.tracks()[i];
+    ASSERT_EQ(t.absoluteTicks.size(), t.events.size());
+    EXPECT_EQ(t.seek(0), f.tracks[i].seek(0));
+    EXPECT_EQ(t.seek(1000), f.tracks[i].seek(1000));
+  }
+  EXPECT_EQ(c.toFlatMidiFile(), f);
+}
+
+TEST_P(MidiCache, ViewsMatchFlatTrack) {
+  auto f = MidiParser::Parser().parseFlat(data);
+  MidiParser::writeCache(f, 0, cache);
+  MidiParser::CachedMidiFile c(cache);
+  ASSERT_EQ(c.tracks().size(), f.tracks.size());
+  for (size_t i = 0; i < f.tracks.size(); ++i) {
+    const auto& t = c.tracks()[i];
+    EXPECT_EQ(t.length, f.tracks[i].length);
+    ASSERT_EQ(t.events.size(), f.tracks[i].events.size());
+    size_t n = 0;
+    for (MidiParser::EventView e : t.views()) {
+      EXPECT_EQ(MidiParser::toTrackEvent(e),
+                MidiParser::toTrackEvent(f.tracks[i].view(n++)));
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, MidiCache,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(MidiCacheHash, DependsOnEveryByte) {
+  std::vector<std::byte> bytes(37, std::byte{7});
+  uint64_t hash = MidiParser::contentHash(bytes);
+  EXPECT_EQ(MidiParser::contentHash(bytes), hash);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] ^= std::byte{1};
+    EXPECT_NE(MidiParser::contentHash(bytes), hash) << i;
+    bytes[i] ^= std::byte{1};
+  }
+  EXPECT_NE(MidiParser::contentHash(std::span(bytes).first(36)), hash);
+}
+
+TEST(MidiCacheHash, NamesCacheAfterHash) {
+  EXPECT_EQ(MidiParser::cacheFileName(0xABC), "0000000000000abc.midicache");
+}
+
+TEST(MidiCacheLoad, RejectsOtherFiles) {
+  std::string data = std::string(EXAMPLES_DIR) + "/cmaj.mid";
+  EXPECT_THROW(MidiParser::CachedMidiFile{data}, std::runtime_error);
+}
+
+TEST(MidiCacheLoad, RejectsTruncatedCache) {
+  std::string cache = cachePath("truncated");
+  auto f = MidiParser::Parser().parseFlat(std::string(EXAMPLES_DIR) +
+                                          "/mozart.mid");
+  MidiParser::writeCache(f, 0, cache);
+  // Sections are padded to 8 bytes, so cutting off fewer may only remove
+  // padding.
+  std::filesystem::resize_file(cache, std::filesystem::file_size(cache) - 8);
+  EXPECT_THROW(MidiParser::CachedMidiFile{cache}, std::runtime_error);
+  std::filesystem::remove(cache);
+}
+
+TEST(MidiCacheLoad, RejectsOtherVersion) {
+  std::string cache = cachePath("version");
+  MidiParser::writeCache(MidiParser::FlatMidiFile{}, 0, cache);
+  {
+    std::fstream file(cache, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(8);
+    uint32_t version = MidiParser::CACHE_VERSION + 1;
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  EXPECT_THROW(MidiParser::CachedMidiFile{cache}, std::runtime_error);
+  std::filesystem::remove(cache);
+}
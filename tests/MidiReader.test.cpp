@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#include "MidiReader.hpp"
+#include "Parser.hpp"
+#include "read.hpp"
+
+static_assert(std::ranges::input_range<MidiParser::TrackReader>);
+
+class MidiReader : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+namespace {
+
+void expectSameEvents(MidiParser::MidiReader& reader,
+                      const MidiParser::MidiFile& file) {
+  EXPECT_EQ(reader.fileFormat(), file.fileFormat);
+  EXPECT_EQ(reader.numTracks(), file.numTracks);
+  EXPECT_EQ(reader.tickDivision(), file.tickDivision);
+  size_t trackIndex = 0;
+  while (auto track = reader.nextTrack()) {
+    const auto& events = file.tracks.at(trackIndex++).events;
+    size_t i = 0;
+    for (MidiParser::EventView e : *track) {
+      ASSERT_LT(i, events.size());
+      EXPECT_EQ(MidiParser::toTrackEvent(e), events[i++]);
+    }
+    EXPECT_EQ(i, events.size());
+    EXPECT_TRUE(track->done());
+    EXPECT_EQ(track->remaining(), 0);
+  }
+  EXPECT_EQ(trackIndex, file.tracks.size());
+}
+
+}  // namespace
+
+TEST_P(MidiReader, MappedFileMatchesParser) {
+  MidiParser::MidiReader reader(data);
+  expectSameEvents(reader, MidiParser::Parser().parse(data));
+}
+
+TEST_P(MidiReader, BufferMatchesParser) {
+  std::ifstream file(data, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  MidiParser::MidiReader reader(std::as_bytes(std::span(bytes)));
+  expectSameEvents(reader, MidiParser::Parser().parse(data));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, MidiReader,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(TrackReader, YieldsEventsLazilyWithRunningStatus) {
+  std::vector<uint8_t> track = {0x00, 0x90, 60, 100,  // note on
+                                0x10, 62,   100,       // running status
+                                0x10, 0x80, 60, 0,     // note off
+                                0x00, 0xFF, 0x2F, 0x00};
+  MidiParser::TrackReader reader(track);
+  auto first = reader.next();
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first->status, 0x90);
+  EXPECT_EQ(reader.remaining(), track.size() - 4);
+  auto second = reader.next();
+  ASSERT_TRUE(second);
+  EXPECT_EQ(second->status, 0x90);
+  EXPECT_EQ(second->deltaTime, 0x10);
+  EXPECT_EQ(second->data[0], 62);
+  EXPECT_EQ(reader.next()->status, 0x80);
+  EXPECT_EQ(reader.next()->kind, MidiParser::EventKind::META);
+  EXPECT_TRUE(reader.done());
+  EXPECT_FALSE(reader.next());
+}
+
+TEST(TrackReader, ThrowsWhenEndOfTrackIsMissing) {
+  std::vector<uint8_t> track = {0x00, 0x90, 60, 100};
+  MidiParser::TrackReader reader(track);
+  EXPECT_TRUE(reader.next());
+  EXPECT_THROW(reader.next(), std::runtime_error);
+}
+
+TEST(TrackReader, TryNextReturnsErrorsInsteadOfThrowing) {
+  std::vector<uint8_t> track = {0x00, 0xFF, 0x2F, 0x00, 0x00};
+  MidiParser::TrackReader reader(track);
+  auto e = reader.tryNext();
+  ASSERT_FALSE(e);
+  EXPECT_EQ(e.error().error, MidiParser::TrackError::DATA_AFTER_END_OF_TRACK);
+  EXPECT_EQ(e.error().position, track.data() + 4);
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NoteTable.hpp"
+#include "Parser.hpp"
+
+namespace {
+
+/**
+ * Feeds MIDI events given as absolute tick, status and two data bytes to a
+ * pairer for track `0`, finishing it at the last tick.
+ */
+MidiParser::NoteTable pair(
+    const std::vector<std::pair<uint64_t, std::vector<uint8_t>>>& events) {
+  MidiParser::NoteTable table;
+  MidiParser::NotePairer pairer(table, 0);
+  uint64_t tick = 0;
+  for (const auto& [t, bytes] : events) {
+    tick = t;
+    pairer.add({0, MidiParser::EventKind::MIDI, bytes[0],
+                std::span(bytes).subspan(1)},
+               tick);
+  }
+  pairer.finish(tick);
+  return table;
+}
+
+}  // namespace
+
+TEST(NotePairer, PairsNoteOnWithNoteOff) {
+  auto t = pair({{10, {0x91, 60, 100}}, {30, {0x81, 60, 64}}});
+  ASSERT_EQ(t.size(), 1);
+  EXPECT_EQ(t.start[0], 10);
+  EXPECT_EQ(t.duration[0], 20);
+  EXPECT_EQ(t.pitch[0], 60);
+  EXPECT_EQ(t.velocity[0], 100);
+  EXPECT_EQ(t.channel[0], 1);
+  EXPECT_EQ(t.track[0], 0);
+}
+
+TEST(NotePairer, NoteOnWithZeroVelocityEndsNote) {
+  auto t = pair({{0, {0x90, 60, 100}}, {5, {0x90, 60, 0}}});
+  ASSERT_EQ(t.size(), 1);
+  EXPECT_EQ(t.duration[0], 5);
+  EXPECT_EQ(t.unfinishedNotes, 0);
+}
+
+TEST(NotePairer, OverlappingNotesEndFirstInFirstOut) {
+  auto t = pair({{0, {0x90, 60, 1}},
+                 {10, {0x90, 60, 2}},
+                 {20, {0x80, 60, 0}},
+                 {40, {0x80, 60, 0}}});
+  ASSERT_EQ(t.size(), 2);
+  EXPECT_EQ(t.velocity[0], 1);
+  EXPECT_EQ(t.duration[0], 20);
+  EXPECT_EQ(t.velocity[1], 2);
+  EXPECT_EQ(t.duration[1], 30);
+}
+
+TEST(NotePairer, KeepsChannelsAndKeysApart) {
+  auto t = pair({{0, {0x90, 60, 1}},
+                 {0, {0x91, 60, 2}},
+                 {0, {0x90, 61, 3}},
+                 {10, {0x91, 60, 0}},
+                 {20, {0x80, 61, 0}},
+                 {30, {0x80, 60, 0}}});
+  ASSERT_EQ(t.size(), 3);
+  EXPECT_EQ(t.duration, (std::vector<uint64_t>{30, 10, 20}));
+}
+
+TEST(NotePairer, CountsDanglingNoteOffs) {
+  auto t = pair({{0, {0x80, 60, 0}},
+                 {5, {0x90, 60, 100}},
+                 {10, {0x80, 60, 0}},
+                 {15, {0x80, 60, 0}}});
+  ASSERT_EQ(t.size(), 1);
+  EXPECT_EQ(t.duration[0], 5);
+  EXPECT_EQ(t.danglingNoteOffs, 2);
+}
+
+TEST(NotePairer, EndsUnfinishedNotesAtLastEvent) {
+  auto t = pair({{0, {0x90, 60, 100}},
+                 {10, {0x90, 62, 100}},
+                 {50, {0xB0, 7, 100}}});
+  ASSERT_EQ(t.size(), 2);
+  EXPECT_EQ(t.duration, (std::vector<uint64_t>{50, 40}));
+  EXPECT_EQ(t.unfinishedNotes, 2);
+}
+
+TEST(NotePairer, IgnoresOtherEvents) {
+  auto t = pair({{0, {0xA0, 60, 100}}, {0, {0xE0, 0, 64}}});
+  EXPECT_EQ(t.size(), 0);
+  EXPECT_EQ(t.danglingNoteOffs, 0);
+}
+
+TEST(MergeNotes, OrdersByStartThenTrack) {
+  MidiParser::NoteTable a, b;
+  a.append(0, 1, 60, 1, 0, 0);
+  a.append(20, 1, 60, 1, 0, 0);
+  a.danglingNoteOffs = 1;
+  b.append(10, 1, 61, 1, 0, 1);
+  b.append(20, 1, 61, 1, 0, 1);
+  b.unfinishedNotes = 2;
+  std::vector<const MidiParser::NoteTable*> tables = {&a, &b};
+  auto merged = MidiParser::mergeNotes(tables);
+  EXPECT_EQ(merged.start, (std::vector<uint64_t>{0, 10, 20, 20}));
+  EXPECT_EQ(merged.track, (std::vector<uint16_t>{0, 1, 0, 1}));
+  EXPECT_EQ(merged.danglingNoteOffs, 1);
+  EXPECT_EQ(merged.unfinishedNotes, 2);
+}
+
+TEST(MergeNotes, ParallelMergeMatchesSerialMerge) {
+  // Enough notes to be split into ranges, with many shared start ticks.
+  std::vector<MidiParser::NoteTable> tables(5);
+  for (uint16_t i = 0; i < tables.size(); ++i) {
+    uint64_t tick = 0;
+    for (uint64_t n = 0; n < 40000; ++n) {
+      tick += (n * 7 + i) % 3;
+      tables[i].append(tick, n, static_cast<uint8_t>(n % 128), 1, 0, i);
+    }
+  }
+  std::vector<const MidiParser::NoteTable*> pointers;
+  for (const auto& t : tables) {
+    pointers.emplace_back(&t);
+  }
+  MidiParser::ThreadPool pool(3);
+  auto serial = MidiParser::mergeNotes(pointers);
+  auto parallel = MidiParser::mergeNotes(pointers, &pool);
+  EXPECT_EQ(parallel, serial);
+  EXPECT_TRUE(std::ranges::is_sorted(serial.start));
+}
+
+class PairNotes : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(PairNotes, MatchesEventsOfEveryTrack) {
+  auto f = MidiParser::Parser({.pairNotes = true}).parseFlat(data);
+  ASSERT_TRUE(f.notes);
+  size_t total = 0;
+  for (size_t i = 0; i < f.tracks.size(); ++i) {
+    const auto& t = f.tracks[i];
+    size_t noteOns = 0;
+    for (MidiParser::EventView e : t.views()) {
+      noteOns += e.kind == MidiParser::EventKind::MIDI &&
+                 (e.status & 0xF0) == 0x90 && e.data[1] != 0;
+    }
+    EXPECT_EQ(t.notes.size(), noteOns);
+    EXPECT_TRUE(std::ranges::is_sorted(t.notes.start));
+    EXPECT_TRUE(std::ranges::all_of(
+        t.notes.track, [i](uint16_t track) { return track == i; }));
+    total += t.notes.size();
+  }
+  EXPECT_EQ(f.notes->size(), total);
+  EXPECT_TRUE(std::ranges::is_sorted(f.notes->start));
+}
+
+TEST_P(PairNotes, SeesEventsTheFilterSkips) {
+  auto all = MidiParser::Parser({.pairNotes = true}).parse(data);
+  auto none = MidiParser::Parser({.pairNotes = true,
+                                  .filter = MidiParser::EventFilter::none()})
+                  .parse(data);
+  EXPECT_EQ(none.notes, all.notes);
+  for (const auto& t : none.tracks) {
+    EXPECT_TRUE(t.events.empty());
+  }
+}
+
+TEST_P(PairNotes, OffByDefault) {
+  auto f = MidiParser::Parser().parse(data);
+  EXPECT_FALSE(f.notes);
+  for (const auto& t : f.tracks) {
+    EXPECT_EQ(t.notes.size(), 0);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, PairNotes,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
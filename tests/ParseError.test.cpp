@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Parser.hpp"
+#include "SyntheticMidi.hpp"
+
+namespace {
+
+using MidiParser::ParseError;
+using MidiParser::ParseErrorKind;
+
+/**
+ * Builds a format 1 file from the data of its track chunks.
+ */
+std::vector<uint8_t> midiFile(const std::vector<std::vector<uint8_t>>& tracks) {
+  std::vector<uint8_t> bytes = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0,
+                                static_cast<uint8_t>(tracks.size()), 0, 96};
+  for (const auto& t : tracks) {
+    auto size = static_cast<uint32_t>(t.size());
+    bytes.insert(bytes.end(),
+                 {'M', 'T', 'r', 'k', static_cast<uint8_t>(size >> 24),
+                  static_cast<uint8_t>(size >> 16),
+                  static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size)});
+    bytes.insert(bytes.end(), t.begin(), t.end());
+  }
+  return bytes;
+}
+
+const std::vector<uint8_t> END_OF_TRACK = {0x00, 0xFF, 0x2F, 0x00};
+
+/**
+ * Two tracks, the second of which has a note on event cut off after its
+ * first data byte, at offset `38` of the file.
+ */
+const std::vector<uint8_t> TRUNCATED =
+    midiFile({END_OF_TRACK, {0x00, 0x90, 0x3C, 0x40, 0x10, 0x90, 0x3E}});
+
+}  // namespace
+
+TEST(TryParse, MatchesParse) {
+  std::string path = std::string(EXAMPLES_DIR) + "/mozart.mid";
+  MidiParser::Parser parser;
+  auto result = parser.tryParse(path);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, parser.parse(path));
+  EXPECT_TRUE(result->errors.empty());
+}
+
+TEST(TryParse, ReportsMissingFile) {
+  auto result = MidiParser::Parser().tryParse("does/not/exist.mid");
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().kind, ParseErrorKind::IO);
+  EXPECT_FALSE(result.error().track);
+}
+
+TEST(TryParse, ReportsIncompleteHeader) {
+  std::vector<uint8_t> bytes = {'M', 'T', 'h', 'd', 0, 0, 0, 6};
+  auto result = MidiParser::Parser().tryParse(std::as_bytes(std::span(bytes)));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().kind, ParseErrorKind::INVALID_HEADER);
+  EXPECT_EQ(result.error().offset, 0);
+}
+
+TEST(TryParse, ReportsChunkRunningPastEndOfFile) {
+  auto bytes = midiFile({END_OF_TRACK, END_OF_TRACK});
+  bytes.pop_back();
+  auto result = MidiParser::Parser().tryParse(std::as_bytes(std::span(bytes)));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().kind, ParseErrorKind::INVALID_CHUNK);
+  EXPECT_EQ(result.error().offset, 26);
+  EXPECT_EQ(result.error().track, 1);
+}
+
+TEST(TryParse, ReportsTruncatedEventFromWorkerThread) {
+  MidiParser::ThreadPool pool(2);
+  MidiParser::Parser parser(pool, {.inlineTrackThreshold = 0});
+  auto result = parser.tryParse(std::as_bytes(std::span(TRUNCATED)));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().kind, ParseErrorKind::TRUNCATED_EVENT);
+  EXPECT_EQ(result.error().offset, 38);
+  EXPECT_EQ(result.error().track, 1);
+  EXPECT_FALSE(result.error().message.empty());
+}
+
+TEST(TryParse, ParseStillThrowsTrackErrors) {
+  MidiParser::ThreadPool pool(2);
+  MidiParser::Parser parser(pool, {.inlineTrackThreshold = 0});
+  try {
+    parser.parse(std::as_bytes(std::span(TRUNCATED)));
+    FAIL();
+  } catch (const MidiParser::DecodeError& e) {
+    EXPECT_EQ(e.kind(), ParseErrorKind::TRUNCATED_EVENT);
+    EXPECT_EQ(e.track(), 1);
+  }
+  auto valid = midiFile({END_OF_TRACK, {0x00, 0x90, 0x3C, 0x40, 0x00, 0xFF,
+                                        0x2F, 0x00}});
+  EXPECT_EQ(parser.parse(std::as_bytes(std::span(valid))).tracks.size(), 2);
+}
+
+TEST(TryParse, ReportsMissingEndOfTrack) {
+  auto bytes = midiFile({END_OF_TRACK, {0x00, 0x90, 0x3C, 0x40}});
+  auto result = MidiParser::Parser().tryParse(std::as_bytes(std::span(bytes)));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().kind, ParseErrorKind::MISSING_END_OF_TRACK);
+  EXPECT_EQ(result.error().offset, bytes.size());
+  EXPECT_EQ(result.error().track, 1);
+}
+
+TEST(TryParse, ReportsInvalidEvent) {
+  auto bytes = midiFile({{0x00, 0x3C, 0x40, 0x00, 0xFF, 0x2F, 0x00}});
+  auto result = MidiParser::Parser().tryParse(std::as_bytes(std::span(bytes)));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().kind, ParseErrorKind::INVALID_EVENT);
+  EXPECT_EQ(result.error().offset, 23);
+  EXPECT_EQ(result.error().track, 0);
+}
+
+TEST(Lenient, KeepsEventsBeforeError) {
+  MidiParser::ThreadPool pool(2);
+  MidiParser::Parser parser(
+      pool, {.inlineTrackThreshold = 0, .lenient = true, .pairNotes = true});
+  auto data = std::as_bytes(std::span(TRUNCATED));
+  auto result = parser.tryParse(data);
+  ASSERT_TRUE(result);
+  ASSERT_EQ(result->tracks.size(), 2);
+  EXPECT_EQ(result->tracks[0].events.size(), 1);
+  EXPECT_EQ(result->tracks[1].events.size(), 1);
+  EXPECT_EQ(result->tracks[1].notes.size(), 1);
+  EXPECT_EQ(result->tracks[1].notes.unfinishedNotes, 1);
+  ASSERT_EQ(result->errors.size(), 1);
+  const ParseError& error = result->errors[0];
+  EXPECT_EQ(error.kind, ParseErrorKind::TRUNCATED_EVENT);
+  EXPECT_EQ(error.offset, 38);
+  EXPECT_EQ(error.track, 1);
+  EXPECT_EQ(parser.parseFlat(data).errors, result->errors);
+  EXPECT_EQ(parser.parseColumnar(data).errors, result->errors);
+}
+
+TEST(Lenient, StillFailsOnDamagedChunks) {
+  auto bytes = TRUNCATED;
+  bytes.pop_back();
+  auto result = MidiParser::Parser({.lenient = true})
+                    .tryParse(std::as_bytes(std::span(bytes)));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().kind, ParseErrorKind::INVALID_CHUNK);
+}
+
+TEST(Lenient, SplitTrackMatchesSerialDecoding) {
+  auto bytes = SyntheticMidi::generate({.tracks = 1, .eventsPerTrack = 5000});
+  bytes[bytes.size() - 2] = 0x01;  // End of Track becomes a text event.
+  auto data = std::as_bytes(std::span(bytes));
+  MidiParser::ThreadPool pool(2);
+  MidiParser::Parser split(pool, {.inlineTrackThreshold = 256,
+                                  .splitTrackThreshold = 0,
+                                  .lenient = true});
+  auto result = split.parse(data);
+  EXPECT_EQ(result, MidiParser::Parser({.lenient = true}).parse(data));
+  EXPECT_EQ(result.tracks[0].events.size(), 5001);
+  ASSERT_EQ(result.errors.size(), 1);
+  EXPECT_EQ(result.errors[0].kind, ParseErrorKind::MISSING_END_OF_TRACK);
+  EXPECT_EQ(result.errors[0].offset, bytes.size());
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+#include "Parser.hpp"
+
+namespace {
+
+using MidiParser::EventKind;
+
+uint64_t countEvents(const MidiParser::MidiFile& m, EventKind kind) {
+  uint64_t count = 0;
+  for (const auto& t : m.tracks) {
+    for (const auto& e : t.events) {
+      count += std::visit(
+          [&](const auto& event) {
+            using T = std::decay_t<decltype(event)>;
+            switch (kind) {
+              case EventKind::MIDI:
+                return std::is_same_v<T, MidiParser::MIDIEvent>;
+              case EventKind::META:
+                return std::is_same_v<T, MidiParser::MetaEvent>;
+              case EventKind::SYSEX:
+                break;
+            }
+            return std::is_same_v<T, MidiParser::SysExEvent>;
+          },
+          e);
+    }
+  }
+  return count;
+}
+
+}  // namespace
+
+class ParseStats : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(ParseStats, NothingRecordedByDefault) {
+  MidiParser::Parser parser;
+  parser.parse(data);
+  EXPECT_EQ(parser.stats().bytesRead, 0);
+  EXPECT_TRUE(parser.stats().tracks.empty());
+}
+
+TEST_P(ParseStats, CountsMatchOutput) {
+  MidiParser::Parser parser({.collectStats = true});
+  auto m = parser.parse(data);
+  const auto& stats = parser.stats();
+  EXPECT_EQ(stats.bytesRead, std::filesystem::file_size(data));
+  for (auto kind : {EventKind::MIDI, EventKind::META, EventKind::SYSEX}) {
+    EXPECT_EQ(stats.eventCount(kind), countEvents(m, kind));
+  }
+  ASSERT_EQ(stats.tracks.size(), m.tracks.size());
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    EXPECT_EQ(stats.tracks[i].bytes, m.tracks[i].length);
+    EXPECT_EQ(stats.tracks[i].decodedEvents, m.tracks[i].events.size());
+    EXPECT_GE(stats.tracks[i].allocations, 1);
+  }
+}
+
+TEST_P(ParseStats, FlatCountsMatchMidiTrackCounts) {
+  MidiParser::Parser parser({.collectStats = true});
+  parser.parse(data);
+  auto events = parser.stats().events;
+  auto f = parser.parseFlat(data);
+  EXPECT_EQ(parser.stats().events, events);
+  EXPECT_GE(parser.stats().allocations, f.tracks.size());
+}
+
+TEST_P(ParseStats, FilteredEventsAreDecodedButNotKept) {
+  MidiParser::Parser parser(
+      {.filter = MidiParser::EventFilter::none().keepMeta(
+           MidiParser::Meta::END_OF_TRACK),
+       .collectStats = true});
+  auto m = parser.parse(data);
+  const auto& stats = parser.stats();
+  EXPECT_EQ(stats.eventCount(EventKind::META), m.tracks.size());
+  EXPECT_EQ(stats.eventCount(EventKind::MIDI), 0);
+  for (const auto& t : stats.tracks) {
+    EXPECT_GE(t.decodedEvents, 1);
+  }
+}
+
+TEST_P(ParseStats, ThreadTimesAreConsistent) {
+  MidiParser::ThreadPool pool(2);
+  MidiParser::Parser parser(pool,
+                            {.inlineTrackThreshold = 0, .collectStats = true});
+  parser.parse(data);
+  const auto& stats = parser.stats();
+  EXPECT_GT(stats.ioTime.count(), 0);
+  EXPECT_EQ(stats.threadsAvailable, 3);
+  EXPECT_GE(stats.threadsUsed, 1);
+  EXPECT_LE(stats.threadsUsed, 3);
+  EXPECT_GE(stats.utilization(), 0.0);
+  EXPECT_LE(stats.utilization(), 1.0);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, ParseStats,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
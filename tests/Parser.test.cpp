@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "MidiFile.hpp"
 #include "Parser.hpp"
@@ -53,6 +57,30 @@ TEST_P(Parser, SizesReadMatchesRealSize) {
   EXPECT_EQ(s, file.tellg());
 }
 
+TEST_P(Parser, ParsingSpanMatchesParsingFile) {
+  std::ifstream file(data, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  auto fromFile = MidiParser::Parser().parse(data);
+  auto fromSpan = MidiParser::Parser().parse(std::as_bytes(std::span(bytes)));
+  EXPECT_EQ(fromFile, fromSpan);
+}
+
+TEST_P(Parser, ParsingMappedFileMatchesParsingFile) {
+  auto fromFile = MidiParser::Parser().parse(data);
+  auto fromMapping = MidiParser::Parser().parseMapped(data);
+  EXPECT_EQ(fromFile, fromMapping);
+}
+
+TEST_P(Parser, ParsingTruncatedSpanThrows) {
+  std::ifstream file(data, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  bytes.resize(bytes.size() / 2);
+  EXPECT_THROW(MidiParser::Parser().parse(std::as_bytes(std::span(bytes))),
+               std::runtime_error);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Basic, Parser, testing::Values("queen", "mozart", "debussy", "mahler"),
     [](const testing::TestParamInfo<std::string>& info) { return info.param; });
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "Parser.hpp"
+#include "StaticMidiFile.hpp"
+
+namespace {
+
+/**
+ * A tempo track and a track with a note played with running status, a SysEx
+ * event and a program change.
+ */
+constexpr std::array<uint8_t, 60> JINGLE = {
+    'M',  'T',  'h',  'd',  0x00, 0x00, 0x00, 0x06, 0x00, 0x01,
+    0x00, 0x02, 0x00, 0x60, 'M',  'T',  'r',  'k',  0x00, 0x00,
+    0x00, 0x0B, 0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20, 0x00,
+    0xFF, 0x2F, 0x00, 'M',  'T',  'r',  'k',  0x00, 0x00, 0x00,
+    0x13, 0x00, 0x90, 0x3C, 0x40, 0x60, 0x3C, 0x00, 0x00, 0xF0,
+    0x7E, 0x7F, 0xF7, 0x10, 0xC0, 0x05, 0x00, 0xFF, 0x2F, 0x00};
+
+/**
+ * `JINGLE` with its last End of Track event cut short.
+ */
+constexpr auto TRUNCATED = [] {
+  std::array<uint8_t, 59> bytes{};
+  std::copy_n(JINGLE.begin(), bytes.size(), bytes.begin());
+  bytes[40] = 0x12;
+  return bytes;
+}();
+
+constexpr auto DECODED =
+    MidiParser::decodeStatic<MidiParser::countEvents(JINGLE)>(JINGLE);
+
+static_assert(DECODED.size() == 7);
+static_assert(DECODED.tickDivision == 0x60);
+static_assert(DECODED[3].tick == 0x60);
+static_assert(DECODED[3].event.status == 0x90);
+static_assert(DECODED[3].event.data[1] == 0x00);
+static_assert(DECODED[5].tick == 0x70);
+static_assert(DECODED.trackEvents(1).size() == 5);
+
+/**
+ * Whether `Bytes` can be decoded in a constant expression.
+ */
+template <const auto& Bytes>
+concept DecodesAtCompileTime = requires {
+  typename std::integral_constant<size_t, MidiParser::countEvents(Bytes)>;
+};
+
+static_assert(DecodesAtCompileTime<JINGLE>);
+static_assert(!DecodesAtCompileTime<TRUNCATED>);
+
+}  // namespace
+
+TEST(StaticMidiFile, MatchesParser) {
+  auto data = std::as_bytes(std::span(JINGLE));
+  auto m = MidiParser::Parser({.buildTimeIndex = true}).parse(data);
+  EXPECT_EQ(DECODED.fileFormat, m.fileFormat);
+  EXPECT_EQ(DECODED.numTracks, m.numTracks);
+  EXPECT_EQ(DECODED.tickDivision, m.tickDivision);
+  size_t i = 0;
+  for (uint16_t t = 0; t < m.tracks.size(); ++t) {
+    auto events = DECODED.trackEvents(t);
+    ASSERT_EQ(events.size(), m.tracks[t].events.size());
+    for (size_t j = 0; j < events.size(); ++j, ++i) {
+      EXPECT_EQ(&events[j], &DECODED[i]);
+      EXPECT_EQ(events[j].track, t);
+      EXPECT_EQ(events[j].tick, m.tracks[t].absoluteTicks[j]);
+      EXPECT_EQ(MidiParser::toTrackEvent(events[j].event),
+                m.tracks[t].events[j]);
+    }
+  }
+  EXPECT_EQ(i, DECODED.size());
+}
+
+TEST(StaticMidiFile, DecodesAtRunTime) {
+  std::vector<uint8_t> bytes(JINGLE.begin(), JINGLE.end());
+  auto decoded = MidiParser::decodeStatic<16>(bytes);
+  ASSERT_EQ(decoded.size(), DECODED.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    EXPECT_EQ(decoded[i].tick, DECODED[i].tick);
+    EXPECT_EQ(decoded[i].event.data.data() - bytes.data(),
+              DECODED[i].event.data.data() - JINGLE.data());
+  }
+}
+
+TEST(StaticMidiFile, ThrowsAtRunTime) {
+  EXPECT_THROW(MidiParser::countEvents(TRUNCATED), MidiParser::DecodeError);
+  EXPECT_THROW(MidiParser::decodeStatic<16>(TRUNCATED),
+               MidiParser::DecodeError);
+  EXPECT_THROW(MidiParser::decodeStatic<6>(JINGLE), std::length_error);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "Parser.hpp"
+#include "SyntheticMidi.hpp"
+#include "Writer.hpp"
+#include "vlq.hpp"
+
+namespace {
+
+MidiParser::MidiFile parse(const std::vector<uint8_t>& bytes,
+                           const MidiParser::ParseOptions& options = {}) {
+  return MidiParser::Parser(options).parse(std::as_bytes(std::span(bytes)));
+}
+
+/**
+ * Reads the variable-length quantity at `offset` and advances `offset` past
+ * it.
+ */
+uint32_t readVlq(const std::vector<uint8_t>& bytes, size_t& offset) {
+  const uint8_t* it = bytes.data() + offset;
+  auto value = MidiParser::decodeVlq(it, bytes.data() + bytes.size());
+  EXPECT_TRUE(value.has_value());
+  offset = static_cast<size_t>(it - bytes.data());
+  return value.value_or(0);
+}
+
+}  // namespace
+
+TEST(SyntheticMidi, SameSeedGivesSameBytes) {
+  SyntheticMidi::Options options{.seed = 7, .tracks = 4, .sysExRate = 0.1};
+  EXPECT_EQ(SyntheticMidi::generate(options), SyntheticMidi::generate(options));
+  auto other = options;
+  other.seed = 8;
+  EXPECT_NE(SyntheticMidi::generate(options), SyntheticMidi::generate(other));
+}
+
+TEST(SyntheticMidi, TracksDoNotDependOnTrackCount) {
+  auto few = parse(SyntheticMidi::generate({.tracks = 2}));
+  auto many = parse(SyntheticMidi::generate({.tracks = 5}));
+  EXPECT_EQ(few.tracks[1].events, many.tracks[1].events);
+}
+
+TEST(SyntheticMidi, ParsesWithRequestedShape) {
+  SyntheticMidi::Options options{.tracks = 8,
+                                 .eventsPerTrack = 5000,
+                                 .sysExRate = 0.05,
+                                 .minSysExSize = 3,
+                                 .maxSysExSize = 1000,
+                                 .metaRate = 0.05};
+  auto m = parse(SyntheticMidi::generate(options));
+  EXPECT_EQ(m.numTracks, 8);
+  ASSERT_EQ(m.tracks.size(), 8);
+  size_t sysEx = 0;
+  size_t meta = 0;
+  for (const auto& t : m.tracks) {
+    ASSERT_EQ(t.events.size(), options.eventsPerTrack + 1);
+    for (const auto& e : t.events) {
+      if (const auto* s = std::get_if<MidiParser::SysExEvent>(&e)) {
+        ++sysEx;
+        // MidiParser keeps the length in front of the data.
+        size_t offset = 0;
+        size_t length = readVlq(s->data, offset);
+        EXPECT_EQ(length, s->data.size() - offset + 1);
+        EXPECT_GE(length - 1, options.minSysExSize);
+        EXPECT_LE(length - 1, options.maxSysExSize);
+      }
+      meta += std::holds_alternative<MidiParser::MetaEvent>(e);
+    }
+  }
+  // 2000 of 40000 events are expected to be SysEx and about 1900 meta, plus
+  // one end of track event per track.
+  EXPECT_GT(sysEx, 1500);
+  EXPECT_LT(sysEx, 2500);
+  EXPECT_GT(meta, 1400);
+  EXPECT_LT(meta, 2500);
+}
+
+// Steps over the events by their declared lengths, as a reader that does
+// not scan for the `F7` ending a SysEx message would.
+TEST(SyntheticMidi, EventsFollowDeclaredLengths) {
+  auto bytes = SyntheticMidi::generate({.tracks = 2,
+                                        .eventsPerTrack = 5000,
+                                        .runningStatus = 0.5,
+                                        .sysExRate = 0.2,
+                                        .minSysExSize = 1,
+                                        .maxSysExSize = 40000});
+  size_t offset = 14;
+  size_t sysEx = 0;
+  for (int t = 0; t < 2; ++t) {
+    ASSERT_EQ(bytes[offset], 'M');
+    size_t end = offset + 8 +
+                 (size_t{bytes[offset + 4]} << 24 |
+                  size_t{bytes[offset + 5]} << 16 |
+                  size_t{bytes[offset + 6]} << 8 | bytes[offset + 7]);
+    offset += 8;
+    uint8_t runningStatus = 0;
+    size_t events = 0;
+    bool endOfTrack = false;
+    while (offset < end) {
+      ASSERT_FALSE(endOfTrack);
+      readVlq(bytes, offset);
+      uint8_t status = bytes[offset];
+      ++events;
+      if (status == 0xFF) {
+        endOfTrack = bytes[offset + 1] == 0x2F;
+        offset += 2;
+        offset += readVlq(bytes, offset);
+      } else if (status == 0xF0) {
+        ++sysEx;
+        ++offset;
+        offset += readVlq(bytes, offset);
+        ASSERT_EQ(bytes[offset - 1], 0xF7);
+      } else {
+        if (status >= 0x80) {
+          runningStatus = status;
+          ++offset;
+        }
+        ASSERT_GE(runningStatus, 0x80);
+        bool oneByte = (runningStatus & 0xE0) == 0xC0;
+        offset += oneByte ? 1 : 2;
+      }
+    }
+    EXPECT_EQ(offset, end);
+    EXPECT_TRUE(endOfTrack);
+    EXPECT_EQ(events, 5001);
+  }
+  EXPECT_EQ(offset, bytes.size());
+  EXPECT_GT(sysEx, 1500);
+  EXPECT_EQ(parse(bytes).tracks[1].events.size(), 5001);
+}
+
+TEST(SyntheticMidi, RunningStatusMatchesWriter) {
+  for (double runningStatus : {0.0, 1.0}) {
+    auto bytes = SyntheticMidi::generate(
+        {.tracks = 3, .eventsPerTrack = 2000, .runningStatus = runningStatus});
+    MidiParser::Writer writer({.runningStatus = runningStatus == 1.0});
+    EXPECT_EQ(writer.write(parse(bytes)), bytes);
+  }
+}
+
+TEST(SyntheticMidi, InvalidSysExRangeThrows) {
+  EXPECT_THROW(SyntheticMidi::generate({.minSysExSize = 0}),
+               std::invalid_argument);
+  EXPECT_THROW(
+      SyntheticMidi::generate({.minSysExSize = 10, .maxSysExSize = 5}),
+      std::invalid_argument);
+}
+
+// Many tracks spread over the pool must decode exactly as they do on one
+// thread.
+TEST(SyntheticMidi, PooledDecodingMatchesInline) {
+  auto bytes = SyntheticMidi::generate({.tracks = 256,
+                                        .eventsPerTrack = 1000,
+                                        .sysExRate = 0.01,
+                                        .metaRate = 0.02});
+  auto inlined = parse(bytes, {.inlineTrackThreshold =
+                                   std::numeric_limits<size_t>::max()});
+  MidiParser::ThreadPool pool(4);
+  auto pooled = MidiParser::Parser(pool, {.inlineTrackThreshold = 0})
+                    .parse(std::as_bytes(std::span(bytes)));
+  EXPECT_EQ(pooled.tracks, inlined.tracks);
+}
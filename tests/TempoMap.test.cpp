@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "IncrementalParser.hpp"
+#include "Parser.hpp"
+#include "TempoMap.hpp"
+
+TEST(TempoMap, UsesDefaultTempoBeforeFirstChange) {
+  MidiParser::TempoMap map(480, {});
+  EXPECT_DOUBLE_EQ(map.ticksToSeconds(0), 0.0);
+  EXPECT_DOUBLE_EQ(map.ticksToSeconds(480), 0.5);
+  EXPECT_EQ(map.secondsToTicks(1.0), 960);
+}
+
+TEST(TempoMap, AccumulatesTimeAcrossChanges) {
+  // 120 bpm for two beats, then 60 bpm.
+  MidiParser::TempoMap map(100, {{200, 1000000}});
+  EXPECT_DOUBLE_EQ(map.ticksToSeconds(200), 1.0);
+  EXPECT_DOUBLE_EQ(map.ticksToSeconds(300), 2.0);
+  EXPECT_EQ(map.secondsToTicks(0.5), 100);
+  EXPECT_EQ(map.secondsToTicks(3.0), 400);
+}
+
+TEST(TempoMap, LastChangeAtSameTickWins) {
+  MidiParser::TempoMap map(100, {{0, 250000}, {0, 1000000}});
+  EXPECT_DOUBLE_EQ(map.ticksToSeconds(100), 1.0);
+}
+
+TEST(TempoMap, SmpteDivisionIgnoresTempo) {
+  // 25 frames per second with 40 ticks per frame is one tick per millisecond.
+  uint16_t division = static_cast<uint8_t>(-25) << 8 | 40;
+  MidiParser::TempoMap map(division, {{0, 1000000}});
+  EXPECT_DOUBLE_EQ(map.ticksToSeconds(1000), 1.0);
+  EXPECT_EQ(map.secondsToTicks(2.5), 2500);
+}
+
+TEST(TempoMap, TimesBeforeStartMapToFirstTick) {
+  MidiParser::TempoMap map(96, {});
+  EXPECT_EQ(map.secondsToTicks(-1.0), 0);
+}
+
+TEST(TempoMap, ZeroDivisionThrows) {
+  EXPECT_THROW(MidiParser::TempoMap(0, {}), std::runtime_error);
+}
+
+class TimeIndex : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(TimeIndex, IsOnlyBuiltWhenRequested) {
+  auto m = MidiParser::Parser().parse(data);
+  EXPECT_FALSE(m.tempoMap);
+  for (const auto& t : m.tracks) {
+    EXPECT_TRUE(t.absoluteTicks.empty());
+  }
+}
+
+TEST_P(TimeIndex, AbsoluteTicksSumDeltaTimes) {
+  auto m = MidiParser::Parser({.buildTimeIndex = true}).parse(data);
+  ASSERT_TRUE(m.tempoMap);
+  for (const auto& t : m.tracks) {
+    ASSERT_EQ(t.absoluteTicks.size(), t.events.size());
+    uint64_t tick = 0;
+    for (size_t i = 0; i < t.events.size(); ++i) {
+      tick += std::visit([](const auto& e) { return e.deltaTime; },
+                         t.events[i]);
+      EXPECT_EQ(t.absoluteTicks[i], tick);
+    }
+  }
+}
+
+TEST_P(TimeIndex, FlatIndexMatchesMidiTrackIndex) {
+  MidiParser::Parser parser({.buildTimeIndex = true});
+  auto m = parser.parse(data);
+  auto f = parser.parseFlat(data);
+  EXPECT_EQ(m.tempoMap, f.tempoMap);
+  ASSERT_EQ(m.tracks.size(), f.tracks.size());
+  for (size_t i = 0; i < m.tracks.size(); ++i) {
+    EXPECT_TRUE(std::ranges::equal(m.tracks[i].absoluteTicks,
+                                   f.tracks[i].absoluteTicks));
+  }
+}
+
+TEST_P(TimeIndex, SeekFindsFirstEventAtOrAfterTime) {
+  auto m = MidiParser::Parser({.buildTimeIndex = true}).parse(data);
+  const auto& map = *m.tempoMap;
+  for (const auto& t : m.tracks) {
+    uint64_t last = t.absoluteTicks.back();
+    double seconds = map.ticksToSeconds(last / 2);
+    size_t i = t.seek(map.secondsToTicks(seconds));
+    ASSERT_LT(i, t.events.size());
+    EXPECT_GE(t.absoluteTicks[i], last / 2);
+    if (i > 0) {
+      EXPECT_LT(t.absoluteTicks[i - 1], last / 2);
+    }
+    EXPECT_EQ(t.seek(last + 1), t.events.size());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, TimeIndex,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+// The tracks of a format 2 file are independent sequences, each with its own
+// tempo, so a map merged from all of them would be wrong for every track.
+TEST(TimeIndex, Format2FilesHaveNoSharedTempoMap) {
+  std::vector<uint8_t> bytes = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 2, 0, 2,
+                                0, 96};
+  for (uint8_t tempo : {uint8_t{0x07}, uint8_t{0x0F}}) {
+    bytes.insert(bytes.end(),
+                 {'M', 'T', 'r', 'k', 0, 0, 0, 15, 0x00, 0xFF, 0x51, 0x03,
+                  tempo, 0xA1, 0x20, 0x60, 0x90, 0x3C, 0x40, 0x00, 0xFF,
+                  0x2F, 0x00});
+  }
+  auto data = std::as_bytes(std::span(bytes));
+  MidiParser::ParseOptions options{.buildTimeIndex = true};
+  MidiParser::Parser parser(options);
+  auto m = parser.parse(data);
+  EXPECT_FALSE(m.tempoMap);
+  ASSERT_EQ(m.tracks.size(), 2);
+  EXPECT_EQ(m.tracks[1].absoluteTicks, (std::vector<uint64_t>{0, 96, 96}));
+  EXPECT_FALSE(parser.parseFlat(data).tempoMap);
+  EXPECT_FALSE(parser.parseColumnar(data).tempoMap);
+  MidiParser::IncrementalParser incremental(options);
+  incremental.update(data);
+  EXPECT_TRUE(incremental.complete());
+  EXPECT_FALSE(incremental.file().tempoMap);
+
+  bytes[9] = 1;
+  EXPECT_TRUE(parser.parse(data).tempoMap);
+}
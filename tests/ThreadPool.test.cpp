@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include "Parser.hpp"
+#include "ThreadPool.hpp"
+
+TEST(ThreadPool, RunsEveryTask) {
+  MidiParser::ThreadPool pool(4);
+  std::atomic<int> count = 0;
+  MidiParser::TaskGroup group(pool);
+  for (int i = 0; i < 1000; ++i) {
+    group.run([&] { ++count; });
+  }
+  group.wait();
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(ThreadPool, NestedGroupsDoNotDeadlock) {
+  MidiParser::ThreadPool pool(1);
+  std::atomic<int> count = 0;
+  MidiParser::TaskGroup outer(pool);
+  for (int i = 0; i < 8; ++i) {
+    outer.run([&] {
+      MidiParser::TaskGroup inner(pool);
+      for (int j = 0; j < 8; ++j) {
+        inner.run([&] { ++count; });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  EXPECT_EQ(count, 64);
+}
+
+TEST(ThreadPool, WaitRethrowsTaskException) {
+  MidiParser::ThreadPool pool(2);
+  MidiParser::TaskGroup group(pool);
+  group.run([] { throw std::runtime_error("task failed"); });
+  group.run([] {});
+  EXPECT_THROW(group.wait(), std::runtime_error);
+}
+
+class SharedPool : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(SharedPool, InlineAndPooledTracksMatch) {
+  MidiParser::ThreadPool pool(3);
+  auto pooled = MidiParser::Parser(pool, {.inlineTrackThreshold = 0});
+  auto inlined = MidiParser::Parser(pool, {.inlineTrackThreshold = SIZE_MAX});
+  EXPECT_EQ(pooled.parse(data), inlined.parse(data));
+}
+
+TEST_P(SharedPool, ParserCanBeReused) {
+  MidiParser::ThreadPool pool(2);
+  MidiParser::Parser p(pool);
+  auto first = p.parse(data);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(first, p.parse(data));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, SharedPool, testing::Values("queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(SharedPool, MalformedTrackThrowsInsteadOfTerminating) {
+  std::vector<uint8_t> bytes = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1,
+                                0,   96,  'M', 'T', 'r', 'k', 0, 0, 0, 3,
+                                0,   0x40, 0x40};
+  MidiParser::Parser p({.inlineTrackThreshold = 0});
+  EXPECT_THROW(p.parse(std::as_bytes(std::span(bytes))), std::runtime_error);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Parser.hpp"
+#include "Writer.hpp"
+
+namespace {
+
+std::vector<std::string> exampleFiles() {
+  std::vector<std::string> names;
+  for (const auto& entry : std::filesystem::directory_iterator(EXAMPLES_DIR)) {
+    if (entry.path().extension() == ".mid") {
+      names.emplace_back(entry.path().stem().string());
+    }
+  }
+  return names;
+}
+
+MidiParser::MidiFile reparse(const std::vector<uint8_t>& bytes) {
+  return MidiParser::Parser().parse(std::as_bytes(std::span(bytes)));
+}
+
+void expectSameEvents(const MidiParser::MidiFile& a,
+                      const MidiParser::MidiFile& b) {
+  EXPECT_EQ(a.fileFormat, b.fileFormat);
+  EXPECT_EQ(a.numTracks, b.numTracks);
+  EXPECT_EQ(a.tickDivision, b.tickDivision);
+  ASSERT_EQ(a.tracks.size(), b.tracks.size());
+  for (size_t i = 0; i < a.tracks.size(); ++i) {
+    EXPECT_EQ(a.tracks[i].events, b.tracks[i].events);
+  }
+}
+
+MidiParser::MidiFile singleTrack(std::vector<MidiParser::TrackEvent> events) {
+  MidiParser::MidiFile f{.fileFormat = 0, .numTracks = 1, .tickDivision = 96};
+  f.tracks.resize(1);
+  f.tracks[0].events = std::move(events);
+  f.tracks[0].events.emplace_back(MidiParser::MetaEvent{
+      .deltaTime = 0,
+      .status = static_cast<uint8_t>(MidiParser::Meta::END_OF_TRACK),
+      .data = {}});
+  return f;
+}
+
+}  // namespace
+
+class RoundTrip : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+};
+
+TEST_P(RoundTrip, WithRunningStatus) {
+  auto m = MidiParser::Parser().parse(data);
+  auto bytes = MidiParser::Writer().write(m);
+  expectSameEvents(reparse(bytes), m);
+}
+
+TEST_P(RoundTrip, WithoutRunningStatus) {
+  auto m = MidiParser::Parser().parse(data);
+  auto bytes = MidiParser::Writer({.runningStatus = false}).write(m);
+  expectSameEvents(reparse(bytes), m);
+}
+
+TEST_P(RoundTrip, ReproducesOriginalBytes) {
+  // Every example either uses running status wherever it can or nowhere.
+  std::ifstream file(data, std::ios::binary);
+  std::vector<uint8_t> original{std::istreambuf_iterator<char>(file), {}};
+  auto m = MidiParser::Parser().parse(data);
+  auto compressed = MidiParser::Writer().write(m);
+  auto uncompressed = MidiParser::Writer({.runningStatus = false}).write(m);
+  EXPECT_TRUE(original == compressed || original == uncompressed);
+}
+
+TEST_P(RoundTrip, TrackLengthsMatchEncodedSize) {
+  auto m = MidiParser::Parser().parse(data);
+  auto r = reparse(MidiParser::Writer().write(m));
+  for (const auto& t : r.tracks) {
+    EXPECT_EQ(t.length, MidiParser::encodedSize(t));
+  }
+}
+
+TEST_P(RoundTrip, SinkMatchesBuffer) {
+  auto m = MidiParser::Parser().parse(data);
+  MidiParser::Writer writer;
+  std::vector<uint8_t> streamed;
+  size_t calls = 0;
+  writer.write(m, [&](std::span<const std::span<const uint8_t>> buffers) {
+    ++calls;
+    for (auto b : buffers) {
+      streamed.insert(streamed.end(), b.begin(), b.end());
+    }
+  });
+  EXPECT_EQ(calls, m.tracks.size() + 1);
+  EXPECT_EQ(streamed, writer.write(m));
+}
+
+TEST_P(RoundTrip, FileMatchesBuffer) {
+  auto m = MidiParser::Parser().parse(data);
+  auto path = std::filesystem::temp_directory_path() /
+              ("MidiParserWriter_" + GetParam() + ".mid");
+  MidiParser::Writer writer;
+  writer.write(m, path.string());
+  std::ifstream file(path, std::ios::binary);
+  std::vector<uint8_t> written{std::istreambuf_iterator<char>(file), {}};
+  file.close();
+  std::filesystem::remove(path);
+  EXPECT_EQ(written, writer.write(m));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Examples, RoundTrip, testing::ValuesIn(exampleFiles()),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(Writer, WritesHeaderChunk) {
+  auto bytes = MidiParser::Writer().write(singleTrack({}));
+  std::vector<uint8_t> header(bytes.begin(), bytes.begin() + 14);
+  EXPECT_EQ(header, (std::vector<uint8_t>{'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0,
+                                          0, 1, 0, 96}));
+}
+
+TEST(Writer, OmitsRepeatedChannelStatus) {
+  auto f = singleTrack({
+      MidiParser::MIDIEvent{.deltaTime = 0, .status = 0x90, .data = {60, 100}},
+      MidiParser::MIDIEvent{.deltaTime = 0, .status = 0x90, .data = {64, 100}},
+      MidiParser::MetaEvent{.deltaTime = 0, .status = 0x01, .data = {'a'}},
+      MidiParser::MIDIEvent{.deltaTime = 0, .status = 0x90, .data = {67, 100}},
+  });
+  auto bytes = MidiParser::Writer().write(f);
+  std::vector<uint8_t> track(bytes.begin() + 22, bytes.end());
+  EXPECT_EQ(track, (std::vector<uint8_t>{0, 0x90, 60, 100, 0, 64, 100, 0, 0xFF,
+                                         0x01, 1, 'a', 0, 0x90, 67, 100, 0,
+                                         0xFF, 0x2F, 0}));
+  expectSameEvents(reparse(bytes), f);
+}
+
+TEST(Writer, WritesMultiByteDeltaTimes) {
+  auto f = singleTrack({MidiParser::MIDIEvent{
+      .deltaTime = 0x4000, .status = 0xC0, .data = {5}}});
+  auto bytes = MidiParser::Writer().write(f);
+  EXPECT_EQ(bytes[22], 0x81);
+  EXPECT_EQ(bytes[23], 0x80);
+  EXPECT_EQ(bytes[24], 0x00);
+  expectSameEvents(reparse(bytes), f);
+}
+
+TEST(Writer, OversizedDeltaTimeThrows) {
+  auto f = singleTrack({MidiParser::MIDIEvent{
+      .deltaTime = 0x10000000, .status = 0xC0, .data = {5}}});
+  EXPECT_THROW(MidiParser::Writer().write(f), std::runtime_error);
+}
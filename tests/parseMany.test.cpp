@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Parser.hpp"
+
+namespace {
+
+const std::vector<std::string> names = {"cmaj",   "twinkle", "queen",
+                                        "mozart", "debussy", "mahler"};
+
+std::string examplePath(const std::string& name) {
+  return std::string(EXAMPLES_DIR) + "/" + name + ".mid";
+}
+
+}  // namespace
+
+TEST(ParseMany, ResultsMatchSingleFileParsesInOrder) {
+  std::vector<std::string> paths;
+  for (const auto& n : names) {
+    paths.emplace_back(examplePath(n));
+  }
+  MidiParser::ThreadPool pool(4);
+  auto results = MidiParser::Parser(pool).parseMany(paths);
+  ASSERT_EQ(results.size(), paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    ASSERT_TRUE(results[i].has_value()) << paths[i];
+    EXPECT_EQ(*results[i], MidiParser::Parser().parse(paths[i])) << paths[i];
+  }
+}
+
+TEST(ParseMany, ReportsPerFileErrors) {
+  std::vector<std::string> paths = {examplePath("cmaj"), "does not exist",
+                                    examplePath("twinkle")};
+  auto results = MidiParser::Parser().parseMany(paths);
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_TRUE(results[0].has_value());
+  ASSERT_FALSE(results[1].has_value());
+  EXPECT_THROW(std::rethrow_exception(results[1].error()),
+               std::ios_base::failure);
+  EXPECT_TRUE(results[2].has_value());
+}
+
+TEST(ParseMany, ParsesBuffers) {
+  std::vector<std::vector<char>> files;
+  std::vector<std::span<const std::byte>> buffers;
+  for (const auto& n : names) {
+    std::ifstream file(examplePath(n), std::ios::binary);
+    files.emplace_back(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  }
+  files.emplace_back(files.front().begin(), files.front().begin() + 10);
+  for (const auto& f : files) {
+    buffers.emplace_back(std::as_bytes(std::span(f)));
+  }
+  auto results = MidiParser::Parser().parseMany(buffers);
+  ASSERT_EQ(results.size(), files.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    ASSERT_TRUE(results[i].has_value());
+    EXPECT_EQ(results[i]->numTracks, results[i]->tracks.size());
+  }
+  EXPECT_FALSE(results.back().has_value());
+}
+
+TEST(ParseMany, CanBeCalledConcurrently) {
+  std::vector<std::string> paths;
+  for (const auto& n : names) {
+    paths.emplace_back(examplePath(n));
+  }
+  MidiParser::ThreadPool pool(2);
+  const MidiParser::Parser parser(pool);
+  std::vector<MidiParser::BatchResult> a;
+  std::vector<MidiParser::BatchResult> b;
+  std::thread other([&] { a = parser.parseMany(paths); });
+  b = parser.parseMany(paths);
+  other.join();
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i], b[i]);
+  }
+}
+
+TEST(ParseMany, HandlesLargeBatches) {
+  std::ifstream file(examplePath("cmaj"), std::ios::binary);
+  std::vector<char> bytes(std::istreambuf_iterator<char>(file), {});
+  // Every track is handed to the pool, so each file waits for its tracks
+  // and the thread waiting may pick up work of other files meanwhile.
+  std::vector<std::span<const std::byte>> buffers(
+      20000, std::as_bytes(std::span(bytes)));
+  MidiParser::ThreadPool pool(1);
+  auto results = MidiParser::Parser(pool, {.inlineTrackThreshold = 0})
+                     .parseMany(buffers);
+  ASSERT_EQ(results.size(), buffers.size());
+  auto expected = MidiParser::Parser().parse(buffers.front());
+  for (const auto& r : results) {
+    ASSERT_TRUE(r.has_value());
+    ASSERT_EQ(*r, expected);
+  }
+}
+
+class ParseManyWithReader : public testing::TestWithParam<bool> {
+ public:
+  /**
+   * Blocks smaller than most of the files, so that their tracks are decoded
+   * before the files have been read completely.
+   */
+  MidiParser::FileReader reader{
+      {.queueDepth = 4, .blockSize = 4096, .useIoUring = GetParam()}};
+};
+
+TEST_P(ParseManyWithReader, ResultsMatchSingleFileParses) {
+  std::vector<std::string> paths;
+  for (const auto& n : names) {
+    paths.emplace_back(examplePath(n));
+  }
+  MidiParser::ThreadPool pool(2);
+  for (auto options : {MidiParser::ParseOptions{.inlineTrackThreshold = 0},
+                       MidiParser::ParseOptions{.buildTimeIndex = true,
+                                                .pairNotes = true},
+                       MidiParser::ParseOptions{.recoverChunks = true}}) {
+    auto results = MidiParser::Parser(pool, options).parseMany(paths, reader);
+    ASSERT_EQ(results.size(), paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+      ASSERT_TRUE(results[i].has_value()) << paths[i];
+      EXPECT_EQ(*results[i], MidiParser::Parser(options).parse(paths[i]))
+          << paths[i];
+    }
+  }
+}
+
+TEST_P(ParseManyWithReader, ReportsPerFileErrors) {
+  auto truncated =
+      (std::filesystem::temp_directory_path() / "MidiParserTruncated.mid")
+          .string();
+  {
+    std::ifstream in(examplePath("mozart"), std::ios::binary);
+    std::vector<char> bytes(std::istreambuf_iterator<char>(in), {});
+    std::ofstream(truncated, std::ios::binary)
+        .write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+  }
+  std::vector<std::string> paths = {examplePath("cmaj"), "does not exist",
+                                    truncated, examplePath("twinkle")};
+  auto results = MidiParser::Parser().parseMany(paths, reader);
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_TRUE(results[0].has_value());
+  ASSERT_FALSE(results[1].has_value());
+  EXPECT_THROW(std::rethrow_exception(results[1].error()),
+               std::ios_base::failure);
+  ASSERT_FALSE(results[2].has_value());
+  EXPECT_THROW(std::rethrow_exception(results[2].error()),
+               MidiParser::DecodeError);
+  EXPECT_TRUE(results[3].has_value());
+  std::filesystem::remove(truncated);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Backends, ParseManyWithReader, testing::Bool(),
+    [](const testing::TestParamInfo<bool>& info) {
+      return info.param ? "IoUring" : "Threads";
+    });
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include <format>
+#include <memory>
 #include "gtest/gtest.h"
 
+#include "enums.hpp"
 #include "read.hpp"
 
 namespace ReadMetaEventTests {
@@ -178,3 +180,128 @@ TEST(Read, DeltaTime) {
 }
 
 }  // namespace ReadDeltaTimeTest
+
+namespace ReadEventTests {
+
+using bytes = std::vector<uint8_t>;
+
+TEST(ReadEvent, ReadsMidiEventAndSetsRunningStatus) {
+  bytes b = {0x83, 0x5F, 0x91, 60, 100};
+  const uint8_t* it = b.data();
+  uint8_t runningStatus = 0;
+  auto e = MidiParser::readEvent(it, b.data() + b.size(), runningStatus);
+  EXPECT_EQ(it, b.data() + b.size());
+  EXPECT_EQ(e.deltaTime, 479);
+  EXPECT_EQ(e.kind, MidiParser::EventKind::MIDI);
+  EXPECT_EQ(e.status, 0x91);
+  EXPECT_EQ(e.data.size(), 2);
+  EXPECT_EQ(runningStatus, 0x91);
+}
+
+TEST(ReadEvent, ReadsRunningStatusEvent) {
+  bytes b = {0x00, 60, 0};
+  const uint8_t* it = b.data();
+  uint8_t runningStatus = 0x80;
+  auto e = MidiParser::readEvent(it, b.data() + b.size(), runningStatus);
+  EXPECT_EQ(it, b.data() + b.size());
+  EXPECT_EQ(e.status, 0x80);
+  EXPECT_EQ(e.data.data(), b.data() + 1);
+}
+
+TEST(ReadEvent, ReadsMetaEventInPlace) {
+  bytes b = {0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20};
+  const uint8_t* it = b.data();
+  uint8_t runningStatus = 0;
+  auto e = MidiParser::readEvent(it, b.data() + b.size(), runningStatus);
+  EXPECT_EQ(it, b.data() + b.size());
+  EXPECT_EQ(e.kind, MidiParser::EventKind::META);
+  EXPECT_EQ(e.status, 0x51);
+  EXPECT_EQ(e.data.data(), b.data() + 4);
+  EXPECT_EQ(e.data.size(), 3);
+}
+
+TEST(ReadEvent, ReadsSysExEventUpToTerminator) {
+  bytes b = {0x00, 0xF0, 1, 2, 3, 0xF7};
+  const uint8_t* it = b.data();
+  uint8_t runningStatus = 0;
+  auto e = MidiParser::readEvent(it, b.data() + b.size(), runningStatus);
+  EXPECT_EQ(it, b.data() + b.size());
+  EXPECT_EQ(e.kind, MidiParser::EventKind::SYSEX);
+  EXPECT_EQ(e.data.size(), 3);
+}
+
+TEST(ReadEvent, ThrowsWithoutRunningStatus) {
+  bytes b = {0x00, 60, 0};
+  const uint8_t* it = b.data();
+  uint8_t runningStatus = 0;
+  EXPECT_THROW(MidiParser::readEvent(it, b.data() + b.size(), runningStatus), std::runtime_error);
+}
+
+TEST(TryReadEvent, ReturnsErrorAndLeavesPositionUnchanged) {
+  bytes b = {0x00, 60, 0};
+  const uint8_t* it = b.data();
+  uint8_t runningStatus = 0;
+  auto e = MidiParser::tryReadEvent(it, b.data() + b.size(), runningStatus);
+  ASSERT_FALSE(e);
+  EXPECT_EQ(e.error().error, MidiParser::TrackError::UNREADABLE);
+  EXPECT_EQ(e.error().position, b.data() + 1);
+  EXPECT_EQ(it, b.data());
+  EXPECT_EQ(MidiParser::toDecodeError(e.error()).kind(),
+            MidiParser::ParseErrorKind::INVALID_EVENT);
+}
+
+class TruncatedEvent : public testing::TestWithParam<bytes> {};
+
+TEST_P(TruncatedEvent, ThrowsInsteadOfReadingPastEnd) {
+  // Copy into an exactly sized heap block so sanitizers catch overreads.
+  auto b = GetParam();
+  auto copy = std::make_unique<uint8_t[]>(b.size());
+  std::copy(b.begin(), b.end(), copy.get());
+  const uint8_t* it = copy.get();
+  uint8_t runningStatus = 0x90;
+  EXPECT_THROW(MidiParser::readEvent(it, copy.get() + b.size(), runningStatus),
+               std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(Reading, TruncatedEvent,
+                         testing::Values(bytes{0x83}, bytes{0x00},
+                                         bytes{0x00, 0x90, 60},
+                                         bytes{0x00, 60},
+                                         bytes{0x00, 0xFF},
+                                         bytes{0x00, 0xFF, 0x51, 0x03, 0x07},
+                                         bytes{0x00, 0xF0, 1, 2, 3},
+                                         bytes{0xFF, 0xFF, 0xFF, 0xFF, 0x7F}));
+
+}  // namespace ReadEventTests
+
+namespace StatusTableTests {
+
+TEST(StatusTable, AgreesWithStatusSets) {
+  using MidiParser::StatusKind;
+  for (int i = 0; i < 256; ++i) {
+    auto status = static_cast<uint8_t>(i);
+    auto high = static_cast<uint8_t>(status & 0b11110000);
+    auto info = MidiParser::STATUS_TABLE[status];
+    SCOPED_TRACE(std::format("{:02X}", status));
+    if (MidiParser::StatusOnlyMIDI.contains(status)) {
+      EXPECT_EQ(info.kind, StatusKind::MIDI);
+      EXPECT_EQ(info.dataLength, 0);
+    } else if (MidiParser::SingleByteMIDI.contains(high) ||
+               MidiParser::SingleByteMIDI.contains(status)) {
+      EXPECT_EQ(info.kind, StatusKind::MIDI);
+      EXPECT_EQ(info.dataLength, 1);
+    } else if (MidiParser::DoubleByteMIDI.contains(high) ||
+               MidiParser::DoubleByteMIDI.contains(status)) {
+      EXPECT_EQ(info.kind, StatusKind::MIDI);
+      EXPECT_EQ(info.dataLength, 2);
+    } else if (status == 0xFF) {
+      EXPECT_EQ(info.kind, StatusKind::META);
+    } else if (status == 0xF0 || status == 0xF7) {
+      EXPECT_EQ(info.kind, StatusKind::SYSEX);
+    } else {
+      EXPECT_EQ(info.kind, StatusKind::DATA);
+    }
+  }
+}
+
+}  // namespace StatusTableTests
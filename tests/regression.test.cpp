@@ -31,3 +31,8 @@ TEST(RegressionTest, ParsingNonExistentFileThrows) {
   MidiParser::Parser p;
   EXPECT_THROW(p.parse("does not exist"), std::ios_base::failure);
 }
+
+TEST(RegressionTest, MappingNonExistentFileThrows) {
+  MidiParser::Parser p;
+  EXPECT_THROW(p.parseMapped("does not exist"), std::ios_base::failure);
+}
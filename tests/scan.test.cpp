@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Parser.hpp"
+#include "scan.hpp"
+
+namespace FindByteTests {
+
+TEST(FindByte, MatchesScalarAtEveryPositionAndLength) {
+  std::vector<uint8_t> bytes(200, 0x42);
+  for (size_t length = 0; length < 100; ++length) {
+    for (size_t offset = 0; offset < 8; ++offset) {
+      const uint8_t* begin = bytes.data() + offset;
+      const uint8_t* end = begin + length;
+      EXPECT_EQ(MidiParser::findByte(begin, end, 0xF7), end);
+      for (size_t target = 0; target < length; ++target) {
+        bytes[offset + target] = 0xF7;
+        EXPECT_EQ(MidiParser::findByte(begin, end, 0xF7), begin + target);
+        EXPECT_EQ(MidiParser::findByteScalar(begin, end, 0xF7),
+                  begin + target);
+        bytes[offset + target] = 0x42;
+      }
+    }
+  }
+}
+
+TEST(FindByte, FindsFirstOfSeveralMatches) {
+  std::vector<uint8_t> bytes(100, 0);
+  bytes[70] = 0xF7;
+  bytes[40] = 0xF7;
+  auto end = bytes.data() + bytes.size();
+  EXPECT_EQ(MidiParser::findByte(bytes.data(), end, 0xF7), bytes.data() + 40);
+}
+
+TEST(FindByte, ReportsImplementation) {
+  auto name = MidiParser::scanImplementation();
+  EXPECT_TRUE(name == "avx2" || name == "sse2" || name == "scalar");
+}
+
+}  // namespace FindByteTests
+
+namespace FindMarkerTests {
+
+TEST(FindMarker, MatchesScalarAtEveryPosition) {
+  std::vector<uint8_t> bytes(120, 'M');
+  const uint8_t* end = bytes.data() + bytes.size();
+  for (size_t target = 0; target + 4 <= bytes.size(); ++target) {
+    std::copy(MidiParser::TRACK_MARKER.begin(), MidiParser::TRACK_MARKER.end(),
+              bytes.begin() + target);
+    EXPECT_EQ(MidiParser::findMarker(bytes.data(), end,
+                                     MidiParser::TRACK_MARKER),
+              bytes.data() + target);
+    EXPECT_EQ(MidiParser::findMarkerScalar(bytes.data(), end,
+                                           MidiParser::TRACK_MARKER),
+              bytes.data() + target);
+    std::fill(bytes.begin(), bytes.end(), 'M');
+  }
+}
+
+TEST(FindMarker, IgnoresPartialMarkerAtEnd) {
+  std::vector<uint8_t> bytes(64, 0);
+  bytes[61] = 'M';
+  bytes[62] = 'T';
+  bytes[63] = 'r';
+  const uint8_t* end = bytes.data() + bytes.size();
+  EXPECT_EQ(
+      MidiParser::findMarker(bytes.data(), end, MidiParser::TRACK_MARKER),
+      end);
+}
+
+}  // namespace FindMarkerTests
+
+namespace RecoverChunksTests {
+
+std::vector<uint8_t> readExample(const std::string& name) {
+  std::ifstream file(std::string(EXAMPLES_DIR) + "/" + name + ".mid",
+                     std::ios::binary);
+  return {std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()};
+}
+
+MidiParser::MidiFile recover(const std::vector<uint8_t>& bytes) {
+  return MidiParser::Parser({.recoverChunks = true})
+      .parse(std::as_bytes(std::span(bytes)));
+}
+
+TEST(RecoverChunks, MatchesStrictParseOnIntactFile) {
+  auto bytes = readExample("queen");
+  EXPECT_EQ(recover(bytes), MidiParser::Parser().parse(
+                                std::as_bytes(std::span(bytes))));
+}
+
+TEST(RecoverChunks, SkipsJunkBeforeHeaderAndBetweenChunks) {
+  auto original = readExample("queen");
+  auto expected = recover(original);
+  // Junk before the header, an alien chunk after it and trailing garbage.
+  std::vector<uint8_t> bytes = {'R', 'I', 'F', 'F', 1, 2, 3, 4};
+  bytes.insert(bytes.end(), original.begin(), original.begin() + 14);
+  bytes.insert(bytes.end(), {'X', 'Y', 'Z', 'W', 0, 0, 0, 2, 0xAB, 0xCD});
+  bytes.insert(bytes.end(), original.begin() + 14, original.end());
+  bytes.insert(bytes.end(), {0, 0, 0});
+  EXPECT_THROW(MidiParser::Parser().parse(std::as_bytes(std::span(bytes))),
+               std::runtime_error);
+  EXPECT_EQ(recover(bytes), expected);
+}
+
+TEST(RecoverChunks, CutsOffTrackWithOversizedLength) {
+  auto bytes = readExample("cmaj");
+  auto expected = recover(bytes);
+  bytes[14 + 4] = 0x7F;  // Declared length of the only track.
+  EXPECT_EQ(recover(bytes).tracks, expected.tracks);
+}
+
+TEST(RecoverChunks, ThrowsWithoutHeader) {
+  std::vector<uint8_t> bytes(64, 0);
+  EXPECT_THROW(recover(bytes), std::runtime_error);
+}
+
+}  // namespace RecoverChunksTests
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Parser.hpp"
+#include "SyntheticMidi.hpp"
+#include "decode.hpp"
+
+namespace {
+
+/**
+ * Options that split every track into segments of at most a few hundred
+ * bytes.
+ */
+MidiParser::ParseOptions splitting(MidiParser::ParseOptions options = {}) {
+  options.inlineTrackThreshold = 256;
+  options.splitTrackThreshold = 0;
+  return options;
+}
+
+}  // namespace
+
+class SplitTrack : public testing::TestWithParam<std::string> {
+ public:
+  std::string data = std::string(EXAMPLES_DIR) + "/" + GetParam() + ".mid";
+  MidiParser::ThreadPool pool{3};
+};
+
+TEST_P(SplitTrack, MatchesSerialDecoding) {
+  MidiParser::Parser serial;
+  MidiParser::Parser split(pool, splitting());
+  EXPECT_EQ(split.parse(data), serial.parse(data));
+  EXPECT_EQ(split.parseFlat(data), serial.parseFlat(data));
+  EXPECT_EQ(split.parseColumnar(data), serial.parseColumnar(data));
+}
+
+TEST_P(SplitTrack, FilterAndTimeIndexMatchSerialDecoding) {
+  MidiParser::ParseOptions options{
+      .buildTimeIndex = true,
+      .filter = MidiParser::EventFilter::none()
+                    .keepChannelMessages(0xC0)
+                    .keepMeta(MidiParser::Meta::END_OF_TRACK)};
+  MidiParser::Parser serial(options);
+  MidiParser::Parser split(pool, splitting(options));
+  EXPECT_EQ(split.parse(data), serial.parse(data));
+  EXPECT_EQ(split.parseFlat(data), serial.parseFlat(data));
+}
+
+TEST_P(SplitTrack, PairsNotesAcrossSegments) {
+  MidiParser::Parser serial({.pairNotes = true});
+  MidiParser::Parser split(pool, splitting({.pairNotes = true}));
+  EXPECT_EQ(split.parse(data), serial.parse(data));
+  EXPECT_EQ(split.parseFlat(data), serial.parseFlat(data));
+}
+
+TEST_P(SplitTrack, StatsCountEveryEvent) {
+  MidiParser::Parser serial({.collectStats = true});
+  MidiParser::Parser split(pool, splitting({.collectStats = true}));
+  serial.parseFlat(data);
+  split.parseFlat(data);
+  EXPECT_EQ(split.stats().events, serial.stats().events);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Basic, SplitTrack,
+    testing::Values("cmaj", "twinkle", "queen", "mozart", "debussy", "mahler"),
+    [](const testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST(SplitTrack, SyntheticSingleTrackMatchesSerialDecoding) {
+  auto bytes = SyntheticMidi::generate({.tracks = 1,
+                                        .eventsPerTrack = 50000,
+                                        .sysExRate = 0.02,
+                                        .maxSysExSize = 2000,
+                                        .metaRate = 0.05});
+  auto data = std::as_bytes(std::span(bytes));
+  MidiParser::ThreadPool pool(3);
+  MidiParser::Parser split(pool, splitting({.buildTimeIndex = true}));
+  MidiParser::Parser serial({.buildTimeIndex = true});
+  EXPECT_EQ(split.parse(data), serial.parse(data));
+  EXPECT_EQ(split.parseFlat(data), serial.parseFlat(data));
+}
+
+TEST(SplitTrack, SplitPointsResumeDecoding) {
+  auto bytes = SyntheticMidi::generate(
+      {.tracks = 1, .eventsPerTrack = 5000, .runningStatus = 1.0});
+  auto track = std::span(bytes).subspan(MidiParser::HEADER_SIZE +
+                                        MidiParser::CHUNK_PREFIX_SIZE);
+  std::vector<MidiParser::TrackEvent> expected;
+  for (auto e : MidiParser::TrackReader(track)) {
+    expected.emplace_back(MidiParser::toTrackEvent(e));
+  }
+  auto found = MidiParser::findSplitPoints(track, 1000);
+  ASSERT_TRUE(found);
+  const auto& points = *found;
+  ASSERT_GT(points.size(), 10);
+  std::vector<MidiParser::TrackEvent> decoded;
+  for (size_t k = 0; k < points.size(); ++k) {
+    EXPECT_GE(points[k].offset, k == 0 ? 0 : points[k - 1].offset + 1000);
+    size_t end = k + 1 < points.size() ? points[k + 1].offset : track.size();
+    MidiParser::decodeSegment(
+        track.first(end), points[k], MidiParser::EventFilter::all(),
+        [](const MidiParser::EventView&, uint64_t) {},
+        [&](const MidiParser::EventView& e, uint64_t) {
+          decoded.emplace_back(MidiParser::toTrackEvent(e));
+        });
+  }
+  EXPECT_EQ(decoded, expected);
+}
+
+TEST(SplitTrack, MalformedTrackStillThrows) {
+  auto bytes = SyntheticMidi::generate({.tracks = 1, .eventsPerTrack = 5000});
+  bytes[bytes.size() - 2] = 0x01;  // End of Track becomes a text event.
+  MidiParser::ThreadPool pool(2);
+  MidiParser::Parser split(pool, splitting());
+  EXPECT_THROW(split.parse(std::as_bytes(std::span(bytes))),
+               std::runtime_error);
+}
@@ -2,6 +2,7 @@
 #include <format>
 
 #include "read.hpp"
+#include "vlq.hpp"
 
 using Input = std::stack<uint8_t>;
 using Expected = uint32_t;
@@ -48,3 +49,97 @@ auto name = [](const testing::TestParamInfo<TestData>& info) {
 };
 
 INSTANTIATE_TEST_SUITE_P(Parser_Method, vlqto32, testing::ValuesIn(data), name);
+
+namespace DecodeVlqTests {
+
+using Bytes = std::vector<uint8_t>;
+using TestData = std::pair<Bytes, uint32_t>;
+
+class decodeVlq : public testing::TestWithParam<TestData> {};
+
+TEST_P(decodeVlq, DecodesAndAdvancesPastQuantity) {
+  auto [bytes, expected] = GetParam();
+  const uint8_t* it = bytes.data();
+  auto value = MidiParser::decodeVlq(it, bytes.data() + bytes.size());
+  ASSERT_TRUE(value);
+  EXPECT_EQ(*value, expected);
+  EXPECT_EQ(it, bytes.data() + bytes.size());
+}
+
+TEST_P(decodeVlq, IgnoresTrailingBytes) {
+  auto [bytes, expected] = GetParam();
+  size_t size = bytes.size();
+  bytes.insert(bytes.end(), {0x81, 0x00});
+  const uint8_t* it = bytes.data();
+  auto value = MidiParser::decodeVlq(it, bytes.data() + bytes.size());
+  ASSERT_TRUE(value);
+  EXPECT_EQ(*value, expected);
+  EXPECT_EQ(it, bytes.data() + size);
+}
+
+TEST_P(decodeVlq, ReportsTruncationWhenLastByteIsMissing) {
+  auto [bytes, expected] = GetParam();
+  const uint8_t* it = bytes.data();
+  auto value = MidiParser::decodeVlq(it, bytes.data() + bytes.size() - 1);
+  ASSERT_FALSE(value);
+  EXPECT_EQ(value.error(), MidiParser::VlqError::TRUNCATED);
+  EXPECT_EQ(it, bytes.data());
+}
+
+TEST_P(decodeVlq, MatchesReadvlq) {
+  auto [bytes, expected] = GetParam();
+  const uint8_t* it = bytes.data();
+  EXPECT_EQ(MidiParser::readvlq(it), expected);
+}
+
+const inline TestData data[] = {
+    {{0x0}, 0x0},
+    {{0x40}, 0x40},
+    {{0x7F}, 0x7F},
+    {{0x81, 0x0}, 0x80},
+    {{0x83, 0x5F}, 479},
+    {{0x87, 0x3F}, 959},
+    {{0xC0, 0x0}, 0x2000},
+    {{0xFF, 0x7F}, 0x3FFF},
+    {{0x81, 0x80, 0x0}, 0x4000},
+    {{0xC0, 0x80, 0x0}, 0x100000},
+    {{0xFF, 0xFF, 0x7F}, 0x1FFFFF},
+    {{0x81, 0x80, 0x80, 0x0}, 0x200000},
+    {{0xC0, 0x80, 0x80, 0x0}, 0x8000000},
+    {{0xFF, 0xFF, 0xFF, 0x7F}, 0x0FFFFFFF},
+};
+
+auto name = [](const testing::TestParamInfo<TestData>& info) {
+  std::string n = "in0x";
+  for (uint8_t b : info.param.first) {
+    n += std::format("{:02X}", b);
+  }
+  return n + std::format("_0x{:08X}", info.param.second);
+};
+
+INSTANTIATE_TEST_SUITE_P(Vlq, decodeVlq, testing::ValuesIn(data), name);
+
+TEST(decodeVlqErrors, EmptyBufferIsTruncated) {
+  Bytes bytes;
+  const uint8_t* it = bytes.data();
+  auto value = MidiParser::decodeVlq(it, it);
+  ASSERT_FALSE(value);
+  EXPECT_EQ(value.error(), MidiParser::VlqError::TRUNCATED);
+}
+
+TEST(decodeVlqErrors, FiveByteQuantityIsTooLong) {
+  Bytes bytes = {0x81, 0x80, 0x80, 0x80, 0x00};
+  const uint8_t* it = bytes.data();
+  auto value = MidiParser::decodeVlq(it, bytes.data() + bytes.size());
+  ASSERT_FALSE(value);
+  EXPECT_EQ(value.error(), MidiParser::VlqError::TOO_LONG);
+  EXPECT_EQ(it, bytes.data());
+}
+
+static_assert([] {
+  const uint8_t bytes[] = {0x83, 0x5F};
+  const uint8_t* it = bytes;
+  return MidiParser::decodeVlq(it, bytes + 2).value() == 479;
+}());
+
+}  // namespace DecodeVlqTests
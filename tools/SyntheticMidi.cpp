@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "SyntheticMidi.hpp"
+
+namespace SyntheticMidi {
+
+namespace {
+
+/**
+ * A splitmix64 generator. The standard distributions are implementation
+ * defined, so all draws go through the members below instead.
+ */
+class Random {
+ public:
+  explicit Random(uint64_t seed) : m_state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (m_state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+  }
+
+  /**
+   * A value in `[0, n)`.
+   */
+  uint64_t below(uint64_t n) { return next() % n; }
+
+  /**
+   * A value in `[min, max]`.
+   */
+  uint64_t between(uint64_t min, uint64_t max) {
+    return min + below(max - min + 1);
+  }
+
+  /**
+   * Whether an event with probability `p` happens.
+   */
+  bool chance(double p) {
+    return static_cast<double>(next() >> 11) * 0x1.0p-53 < p;
+  }
+
+ private:
+  uint64_t m_state;
+};
+
+void appendVlq(uint32_t value, std::vector<uint8_t>& out) {
+  uint8_t buffer[4];
+  int n = 0;
+  do {
+    buffer[n++] = value & 0b01111111;
+    value >>= 7;
+  } while (value != 0);
+  while (n > 1) {
+    out.emplace_back(buffer[--n] | 0b10000000);
+  }
+  out.emplace_back(buffer[0]);
+}
+
+void appendBigEndian(uint64_t value, int bytes, std::vector<uint8_t>& out) {
+  for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8) {
+    out.emplace_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+size_t sysExSize(const Options& options, Random& random) {
+  size_t low = std::bit_width(options.minSysExSize) - 1;
+  size_t high = std::bit_width(options.maxSysExSize) - 1;
+  size_t bucket = random.between(low, high);
+  size_t min = std::max(options.minSysExSize, size_t{1} << bucket);
+  size_t max = std::min(options.maxSysExSize, (size_t{2} << bucket) - 1);
+  size_t size = random.between(min, max);
+  // MidiParser finds the end of a SysEx message by scanning for `F7` rather
+  // than skipping its length, so sizes whose length contains that byte are
+  // moved to the nearest one that does not.
+  auto hasF7 = [](size_t size) {
+    std::vector<uint8_t> length;
+    appendVlq(static_cast<uint32_t>(size + 1), length);
+    return std::ranges::find(length, 0xF7) != length.end();
+  };
+  while (hasF7(size) && size > options.minSysExSize) {
+    --size;
+  }
+  while (hasF7(size)) {
+    ++size;
+  }
+  return size;
+}
+
+void appendMeta(uint8_t type, Random& random, std::vector<uint8_t>& out) {
+  out.insert(out.end(), {0xFF, type});
+  switch (type) {
+    case 0x51:
+      out.emplace_back(3);
+      appendBigEndian(random.between(300000, 1000000), 3, out);
+      return;
+    case 0x58:
+      out.insert(out.end(), {4, static_cast<uint8_t>(random.between(2, 7)),
+                             static_cast<uint8_t>(random.between(1, 3)), 24,
+                             8});
+      return;
+    case 0x59:
+      out.insert(out.end(),
+                 {2, static_cast<uint8_t>(random.between(0, 14) - 7),
+                  static_cast<uint8_t>(random.below(2))});
+      return;
+  }
+  auto length = static_cast<uint32_t>(random.between(1, 32));
+  appendVlq(length, out);
+  for (uint32_t i = 0; i < length; ++i) {
+    out.emplace_back(static_cast<uint8_t>(random.between('a', 'z')));
+  }
+}
+
+void appendChannelMessage(uint8_t channel, Random& random,
+                          uint8_t& runningStatus, const Options& options,
+                          std::vector<uint8_t>& out) {
+  // Mostly notes, with some controllers, program changes and pitch bends.
+  uint64_t kind = random.below(16);
+  uint8_t type = kind < 12 ? 0x90 : kind < 14 ? 0xB0 : kind < 15 ? 0xC0 : 0xE0;
+  auto status = static_cast<uint8_t>(type | channel);
+  if (status != runningStatus || !random.chance(options.runningStatus)) {
+    out.emplace_back(status);
+  }
+  runningStatus = status;
+  out.emplace_back(static_cast<uint8_t>(random.below(128)));
+  if ((status & 0xF0) != 0xC0) {
+    out.emplace_back(static_cast<uint8_t>(random.below(128)));
+  }
+}
+
+void generateTrack(const Options& options, uint16_t index,
+                   std::vector<uint8_t>& out) {
+  Random random(options.seed ^ (uint64_t{index} + 1) * 0xD1B54A32D192ED03);
+  auto channel = static_cast<uint8_t>(index % 16);
+  uint8_t runningStatus = 0;
+  for (size_t i = 0; i < options.eventsPerTrack; ++i) {
+    bool together = random.chance(0.3);
+    appendVlq(together ? 0 : static_cast<uint32_t>(random.below(480)), out);
+    if (random.chance(options.sysExRate)) {
+      size_t size = sysExSize(options, random);
+      out.emplace_back(0xF0);
+      // The length covers the data and the closing `F7`.
+      appendVlq(static_cast<uint32_t>(size + 1), out);
+      for (size_t n = size; n > 0; --n) {
+        out.emplace_back(static_cast<uint8_t>(random.below(128)));
+      }
+      out.emplace_back(0xF7);
+      runningStatus = 0;
+    } else if (!options.metaTypes.empty() && random.chance(options.metaRate)) {
+      appendMeta(options.metaTypes[random.below(options.metaTypes.size())],
+                 random, out);
+      runningStatus = 0;
+    } else {
+      appendChannelMessage(channel, random, runningStatus, options, out);
+    }
+  }
+  out.insert(out.end(), {0x00, 0xFF, 0x2F, 0x00});
+}
+
+/**
+ * Generates the file chunk by chunk, handing each to `write`.
+ */
+template <typename Write>
+void generateChunks(const Options& options, Write&& write) {
+  if (options.minSysExSize == 0 ||
+      options.minSysExSize > options.maxSysExSize) {
+    throw std::invalid_argument("Invalid SysEx size range.");
+  }
+  std::vector<uint8_t> chunk = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1};
+  appendBigEndian(options.tracks, 2, chunk);
+  appendBigEndian(480, 2, chunk);
+  write(chunk);
+  for (uint16_t i = 0; i < options.tracks; ++i) {
+    chunk.assign({'M', 'T', 'r', 'k', 0, 0, 0, 0});
+    generateTrack(options, i, chunk);
+    uint64_t length = chunk.size() - 8;
+    if (length > UINT32_MAX) {
+      throw std::length_error("Track does not fit into a track chunk.");
+    }
+    for (int b = 0; b < 4; ++b) {
+      chunk[4 + b] = static_cast<uint8_t>(length >> (24 - 8 * b));
+    }
+    write(chunk);
+  }
+}
+
+}  // namespace
+
+void generate(const Options& options, std::ostream& out) {
+  generateChunks(options, [&](const std::vector<uint8_t>& chunk) {
+    out.write(reinterpret_cast<const char*>(chunk.data()),
+              static_cast<std::streamsize>(chunk.size()));
+  });
+}
+
+std::vector<uint8_t> generate(const Options& options) {
+  std::vector<uint8_t> bytes;
+  generateChunks(options, [&](const std::vector<uint8_t>& chunk) {
+    bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+  });
+  return bytes;
+}
+
+}  // namespace SyntheticMidi
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace SyntheticMidi {
+
+/**
+ * What `SyntheticMidi::generate` puts into a file. The same options always
+ * produce the same bytes, on every platform.
+ */
+struct Options {
+
+  /**
+   * Seeds the generator. Each track gets its own stream derived from it, so
+   * changing the track count leaves the other tracks unchanged.
+   */
+  uint64_t seed = 1;
+
+  uint16_t tracks = 16;
+
+  /**
+   * The number of events in every track, not counting the end of track event.
+   */
+  size_t eventsPerTrack = 10000;
+
+  /**
+   * The probability that a channel message repeating the previous status
+   * omits it. `1` uses running status wherever possible, `0` never does.
+   */
+  double runningStatus = 1.0;
+
+  /**
+   * The share of events that are SysEx messages.
+   */
+  double sysExRate = 0.0;
+
+  /**
+   * The range of SysEx data sizes in bytes, not counting the length that
+   * follows `F0` or the closing `F7`. Sizes are spread evenly over the powers
+   * of two in between, so small and large messages are both common.
+   */
+  size_t minSysExSize = 1;
+  size_t maxSysExSize = 256;
+
+  /**
+   * The share of events that are meta events.
+   */
+  double metaRate = 0.01;
+
+  /**
+   * The types meta events are evenly drawn from. Text types get 1 to 32
+   * bytes of text, the others the length the standard gives them.
+   */
+  std::vector<uint8_t> metaTypes = {0x01, 0x06, 0x51, 0x58, 0x59};
+};
+
+/**
+ * Writes a format 1 MIDI file to `out`. Only one track is held in memory at
+ * a time, so files of hundreds of MB can be written straight to disk.
+ */
+void generate(const Options& options, std::ostream& out);
+
+/**
+ * Returns the bytes of the file `generate` would write.
+ */
+std::vector<uint8_t> generate(const Options& options);
+
+}  // namespace SyntheticMidi
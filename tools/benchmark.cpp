@@ -1,6 +1,21 @@
+#include <string_view>
+
 #include <MidiParser/Parser.hpp>
 
+// Usage: benchmark [--mmap] [--flat] <file>
 int main(int argc, char* argv[]) {
+  bool mapped = false;
+  bool flat = false;
+  for (int i = 1; i < argc - 1; ++i) {
+    mapped |= std::string_view(argv[i]) == "--mmap";
+    flat |= std::string_view(argv[i]) == "--flat";
+  }
   auto parser = MidiParser::Parser();
-  parser.parse(argv[1]);
+  if (flat) {
+    parser.parseFlat(argv[argc - 1]);
+  } else if (mapped) {
+    parser.parseMapped(argv[argc - 1]);
+  } else {
+    parser.parse(argv[argc - 1]);
+  }
 }
@@ -0,0 +1,75 @@
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <MidiParser/MidiCache.hpp>
+#include <MidiParser/Parser.hpp>
+
+// Usage: build_cache [options] <source directory> <cache directory>
+//
+//   --time-index  store absolute ticks and the tempo map in the caches
+//   --force       rebuild caches that already exist
+//
+// Parses every .mid and .midi file below the source directory and writes its
+// cache to the cache directory, named after the hash of the file's contents.
+// Files whose cache already exists are skipped, so the tool can be rerun
+// whenever the catalog changes. Caches are written to a temporary file first
+// and renamed into place, so readers never see one half written.
+int main(int argc, char* argv[]) {
+  MidiParser::ParseOptions options;
+  bool force = false;
+  std::filesystem::path source;
+  std::filesystem::path cache;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg == "--time-index") {
+      options.buildTimeIndex = true;
+    } else if (arg == "--force") {
+      force = true;
+    } else if (source.empty()) {
+      source = arg;
+    } else {
+      cache = arg;
+    }
+  }
+  if (source.empty() || cache.empty()) {
+    std::cerr << "Usage: build_cache [--time-index] [--force] "
+                 "<source directory> <cache directory>\n";
+    return 1;
+  }
+
+  std::filesystem::create_directories(cache);
+  MidiParser::Parser parser(options);
+  size_t built = 0, skipped = 0, failed = 0;
+  for (const auto& entry :
+       std::filesystem::recursive_directory_iterator(source)) {
+    auto extension = entry.path().extension();
+    if (!entry.is_regular_file() ||
+        (extension != ".mid" && extension != ".midi")) {
+      continue;
+    }
+    try {
+      MidiParser::MappedFile file(entry.path().string());
+      uint64_t hash = MidiParser::contentHash(file.bytes());
+      auto target = cache / MidiParser::cacheFileName(hash);
+      if (!force && std::filesystem::exists(target)) {
+        ++skipped;
+        continue;
+      }
+      auto temporary = target;
+      temporary += ".tmp";
+      MidiParser::writeCache(parser.parseFlat(file.bytes()), hash,
+                             temporary.string());
+      std::filesystem::rename(temporary, target);
+      ++built;
+    } catch (const std::exception& e) {
+      std::cerr << std::format("{}: {}\n", entry.path().string(), e.what());
+      ++failed;
+    }
+  }
+  std::cout << std::format("{} built, {} up to date, {} failed\n", built,
+                           skipped, failed);
+  return failed == 0 ? 0 : 1;
+}
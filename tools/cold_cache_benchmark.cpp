@@ -0,0 +1,137 @@
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <MidiParser/FileReader.hpp>
+#include <MidiParser/Parser.hpp>
+
+// Usage: cold_cache_benchmark <file or directory>...
+//
+// Measures how much of the time spent reading a corpus from disk is hidden
+// behind decoding. Each run starts with the files dropped from the page
+// cache, except for the warm decode run, which only measures decoding:
+//
+//   read      FileReader alone, without decoding anything
+//   decode    Parser::parseMany on files already in the page cache
+//   mapped    Parser::parseMany on a cold cache, mapping each file
+//   streamed  Parser::parseMany with a FileReader on a cold cache
+//
+// The overlap is the time the streamed run saves compared to reading and
+// then decoding. It is only meaningful if eviction works, which it does
+// not on tmpfs or for files with unwritten pages.
+
+namespace {
+
+/**
+ * Asks the kernel to drop the cached pages of `path`. This only works for
+ * pages that have been written back, so run `sync` after creating a corpus.
+ */
+void evict(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+#if defined(POSIX_FADV_DONTNEED)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    close(fd);
+  }
+#endif
+}
+
+double timeCold(const std::vector<std::string>& paths,
+                const std::function<void()>& run) {
+  for (const auto& p : paths) {
+    evict(p);
+  }
+  auto start = std::chrono::steady_clock::now();
+  run();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> paths;
+  uintmax_t totalBytes = 0;
+  for (int i = 1; i < argc; ++i) {
+    auto add = [&](const fs::path& p) {
+      paths.emplace_back(p.string());
+      totalBytes += fs::file_size(p);
+    };
+    if (fs::is_directory(argv[i])) {
+      for (const auto& e : fs::recursive_directory_iterator(argv[i])) {
+        auto ext = e.path().extension();
+        if (e.is_regular_file() && (ext == ".mid" || ext == ".midi")) {
+          add(e.path());
+        }
+      }
+    } else {
+      add(argv[i]);
+    }
+  }
+
+  MidiParser::Parser parser;
+  MidiParser::FileReader reader;
+  auto parseMapped = [&] { parser.parseMany(paths); };
+
+  double read = timeCold(paths, [&] {
+    std::vector<std::vector<std::byte>> buffers(paths.size());
+    reader.read(
+        paths,
+        [&](size_t i, size_t size) {
+          buffers[i].resize(size);
+          return std::span(buffers[i]);
+        },
+        [&](size_t i, size_t bytes) {
+          if (bytes == buffers[i].size()) {
+            buffers[i] = {};
+          }
+        },
+        [](size_t, std::exception_ptr) {});
+  });
+  parseMapped();
+  auto start = std::chrono::steady_clock::now();
+  parseMapped();
+  std::chrono::duration<double> decode =
+      std::chrono::steady_clock::now() - start;
+  double mapped = timeCold(paths, parseMapped);
+  size_t failures = 0;
+  double streamed = timeCold(paths, [&] {
+    for (const auto& r : parser.parseMany(paths, reader)) {
+      failures += r.has_value() ? 0 : 1;
+    }
+  });
+
+  auto report = [&](const char* name, double seconds) {
+    std::cout << std::format("{:<9} {:8.3f} s {:8.2f} MB/sec\n", name, seconds,
+                             static_cast<double>(totalBytes) / 1e6 / seconds);
+  };
+  std::cout << std::format(
+      "{} files ({} failed), {:.2f} MB, {} backend\n", paths.size(), failures,
+      static_cast<double>(totalBytes) / 1e6,
+      reader.backend() == MidiParser::FileReader::Backend::IO_URING
+          ? "io_uring"
+          : "thread");
+  report("read", read);
+  report("decode", decode.count());
+  report("mapped", mapped);
+  report("streamed", streamed);
+  double saved = read + decode.count() - streamed;
+  std::cout << std::format("overlap   {:8.3f} s of the read time hidden\n",
+                           saved);
+}
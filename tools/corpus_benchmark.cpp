@@ -0,0 +1,52 @@
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <MidiParser/Parser.hpp>
+
+// Usage: corpus_benchmark <file or directory>...
+//
+// Parses every .mid file found under the given paths with a single
+// Parser::parseMany call and reports throughput.
+int main(int argc, char* argv[]) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> paths;
+  uintmax_t totalBytes = 0;
+  for (int i = 1; i < argc; ++i) {
+    auto add = [&](const fs::path& p) {
+      paths.emplace_back(p.string());
+      totalBytes += fs::file_size(p);
+    };
+    if (fs::is_directory(argv[i])) {
+      for (const auto& e : fs::recursive_directory_iterator(argv[i])) {
+        auto ext = e.path().extension();
+        if (e.is_regular_file() && (ext == ".mid" || ext == ".midi")) {
+          add(e.path());
+        }
+      }
+    } else {
+      add(argv[i]);
+    }
+  }
+
+  MidiParser::Parser parser;
+  auto start = std::chrono::steady_clock::now();
+  auto results = parser.parseMany(paths);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  size_t failures = 0;
+  for (const auto& r : results) {
+    failures += r.has_value() ? 0 : 1;
+  }
+  double seconds = elapsed.count();
+  std::cout << std::format(
+      "{} files ({} failed), {:.2f} MB in {:.3f} s\n"
+      "{:.1f} files/sec, {:.2f} MB/sec\n",
+      paths.size(), failures, static_cast<double>(totalBytes) / 1e6, seconds,
+      static_cast<double>(paths.size()) / seconds,
+      static_cast<double>(totalBytes) / 1e6 / seconds);
+}
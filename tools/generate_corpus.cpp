@@ -0,0 +1,76 @@
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "SyntheticMidi.hpp"
+
+// Usage: generate_corpus [options] <output directory>
+//
+//   --files n             number of files to write (default 1)
+//   --seed n              seed of the first file; file i uses seed + i
+//   --tracks n            tracks per file (default 16)
+//   --events n            events per track (default 10000)
+//   --running-status p    probability of using running status (default 1)
+//   --sysex-rate p        share of SysEx events (default 0)
+//   --sysex-size min:max  SysEx data size range (default 1:256)
+//   --meta-rate p         share of meta events (default 0.01)
+//
+// Writes deterministic synthetic MIDI files named synthetic_<seed>.mid, for
+// benchmarking and stress testing at scale.
+int main(int argc, char* argv[]) {
+  SyntheticMidi::Options options;
+  size_t files = 1;
+  std::filesystem::path directory;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string_view arg = argv[i];
+      if (i + 1 == argc) {
+        directory = argv[i];
+      } else if (arg == "--files") {
+        files = std::stoul(argv[++i]);
+      } else if (arg == "--seed") {
+        options.seed = std::stoull(argv[++i]);
+      } else if (arg == "--tracks") {
+        options.tracks = static_cast<uint16_t>(std::stoul(argv[++i]));
+      } else if (arg == "--events") {
+        options.eventsPerTrack = std::stoul(argv[++i]);
+      } else if (arg == "--running-status") {
+        options.runningStatus = std::stod(argv[++i]);
+      } else if (arg == "--sysex-rate") {
+        options.sysExRate = std::stod(argv[++i]);
+      } else if (arg == "--sysex-size") {
+        std::string range = argv[++i];
+        size_t colon = range.find(':');
+        options.minSysExSize = std::stoul(range.substr(0, colon));
+        options.maxSysExSize = std::stoul(range.substr(colon + 1));
+      } else if (arg == "--meta-rate") {
+        options.metaRate = std::stod(argv[++i]);
+      } else {
+        throw std::invalid_argument(std::format("Unknown option {}", arg));
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    directory.clear();
+  }
+  if (directory.empty()) {
+    std::cerr << "Usage: generate_corpus [options] <output directory>\n";
+    return 1;
+  }
+
+  std::filesystem::create_directories(directory);
+  uint64_t firstSeed = options.seed;
+  for (size_t i = 0; i < files; ++i) {
+    options.seed = firstSeed + i;
+    auto path = directory / std::format("synthetic_{}.mid", options.seed);
+    std::ofstream out(path, std::ios::binary);
+    SyntheticMidi::generate(options, out);
+    std::cout << std::format("{} {:.2f} MB\n", path.string(),
+                             static_cast<double>(out.tellp()) / 1e6);
+  }
+}
@@ -0,0 +1,239 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <MidiParser/Parser.hpp>
+#include <MidiParser/read.hpp>
+#include <MidiParser/vlq.hpp>
+
+#include "SyntheticMidi.hpp"
+
+// Usage: parser_benchmark [Google Benchmark flags]
+//
+// Microbenchmarks for the event readers, whole-file benchmarks for every file
+// in data/midi_examples and synthetic scaling cases. Every benchmark reports
+// bytes/s and events/s. Write results for comparison across commits with
+// `--benchmark_out=results.json --benchmark_out_format=json`.
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+void setThroughput(benchmark::State& state, size_t bytes, size_t events) {
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+  state.counters["events_per_second"] = benchmark::Counter(
+      static_cast<double>(events),
+      benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void appendVlq(uint32_t value, Bytes& out) {
+  uint8_t buffer[MidiParser::MAX_VLQ_BYTES];
+  int n = 0;
+  do {
+    buffer[n++] = value & 0b01111111;
+    value >>= 7;
+  } while (value != 0);
+  while (n > 1) {
+    out.emplace_back(buffer[--n] | 0b10000000);
+  }
+  out.emplace_back(buffer[0]);
+}
+
+// Reader microbenchmarks. Each buffer holds `count` back-to-back encodings of
+// what the reader expects, without delta times.
+
+constexpr size_t READER_COUNT = 100'000;
+
+void BM_readvlq(benchmark::State& state) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> size(0, 99);
+  Bytes bytes;
+  for (size_t i = 0; i < READER_COUNT; ++i) {
+    uint32_t s = size(rng);
+    uint32_t max = s < 70 ? 0x7F : s < 95 ? 0x3FFF : 0x0FFFFFFF;
+    appendVlq(std::uniform_int_distribution<uint32_t>(0, max)(rng), bytes);
+  }
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (const uint8_t* it = bytes.data(); it != bytes.data() + bytes.size();
+         ++it) {
+      sum += MidiParser::readvlq(it);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  setThroughput(state, bytes.size(), READER_COUNT);
+}
+BENCHMARK(BM_readvlq);
+
+void BM_readMidiEvent(benchmark::State& state) {
+  Bytes bytes;
+  for (size_t i = 0; i < READER_COUNT; ++i) {
+    bool program = i % 8 == 0;
+    bytes.insert(bytes.end(), {static_cast<uint8_t>(program ? 0xC0 : 0x90),
+                               static_cast<uint8_t>(i % 128)});
+    if (!program) {
+      bytes.emplace_back(100);
+    }
+  }
+  for (auto _ : state) {
+    const uint8_t* it = bytes.data();
+    for (size_t i = 0; i < READER_COUNT; ++i) {
+      benchmark::DoNotOptimize(MidiParser::readMidiEvent(it, 0));
+    }
+  }
+  setThroughput(state, bytes.size(), READER_COUNT);
+}
+BENCHMARK(BM_readMidiEvent);
+
+void BM_readMetaEvent(benchmark::State& state) {
+  Bytes bytes;
+  for (size_t i = 0; i < READER_COUNT; ++i) {
+    bool text = i % 4 == 0;
+    uint8_t type = text ? 0x01 : 0x51;
+    bytes.insert(bytes.end(), {0xFF, type});
+    size_t length = text ? 24 : 3;
+    appendVlq(static_cast<uint32_t>(length), bytes);
+    bytes.insert(bytes.end(), length, 'a');
+  }
+  for (auto _ : state) {
+    const uint8_t* it = bytes.data();
+    for (size_t i = 0; i < READER_COUNT; ++i) {
+      benchmark::DoNotOptimize(MidiParser::readMetaEvent(it, 0));
+    }
+  }
+  setThroughput(state, bytes.size(), READER_COUNT);
+}
+BENCHMARK(BM_readMetaEvent);
+
+void BM_readSysExEvent(benchmark::State& state) {
+  auto size = static_cast<size_t>(state.range(0));
+  size_t count = READER_COUNT / size + 1;
+  Bytes bytes;
+  for (size_t i = 0; i < count; ++i) {
+    bytes.emplace_back(0xF0);
+    bytes.insert(bytes.end(), size, 0x41);
+    bytes.emplace_back(0xF7);
+  }
+  for (auto _ : state) {
+    const uint8_t* it = bytes.data();
+    for (size_t i = 0; i < count; ++i) {
+      benchmark::DoNotOptimize(MidiParser::readSysExEvent(it, 0));
+    }
+  }
+  setThroughput(state, bytes.size(), count);
+}
+BENCHMARK(BM_readSysExEvent)->Arg(8)->Arg(256)->Arg(8192);
+
+// Whole-file benchmarks. Files are parsed from memory, so only decoding is
+// measured, and in wall-clock time, since large tracks are decoded on the
+// thread pool.
+
+size_t countEvents(const MidiParser::FlatMidiFile& f) {
+  size_t events = 0;
+  for (const auto& t : f.tracks) {
+    events += t.events.size();
+  }
+  return events;
+}
+
+void parseFile(benchmark::State& state, const Bytes& file, bool flat) {
+  auto data = std::as_bytes(std::span(file));
+  MidiParser::Parser parser;
+  size_t events = countEvents(parser.parseFlat(data));
+  for (auto _ : state) {
+    if (flat) {
+      benchmark::DoNotOptimize(parser.parseFlat(data));
+    } else {
+      benchmark::DoNotOptimize(parser.parse(data));
+    }
+  }
+  setThroughput(state, file.size(), events);
+}
+
+Bytes readFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return Bytes{std::istreambuf_iterator<char>(file), {}};
+}
+
+void registerExamples() {
+  std::vector<std::filesystem::path> paths;
+  for (const auto& entry : std::filesystem::directory_iterator(EXAMPLES_DIR)) {
+    if (entry.path().extension() == ".mid") {
+      paths.emplace_back(entry.path());
+    }
+  }
+  std::ranges::sort(paths);
+  for (const auto& path : paths) {
+    auto file = std::make_shared<Bytes>(readFile(path));
+    std::string name = path.stem().string();
+    for (bool flat : {false, true}) {
+      std::string prefix = flat ? "BM_parseFlat/" : "BM_parse/";
+      benchmark::RegisterBenchmark(
+          (prefix + name).c_str(),
+          [file, flat](benchmark::State& s) { parseFile(s, *file, flat); })
+          ->UseRealTime();
+    }
+  }
+}
+
+// Synthetic scaling cases, see `SyntheticMidi::Options`.
+
+void parseSynthetic(benchmark::State& state,
+                    const SyntheticMidi::Options& options) {
+  parseFile(state, SyntheticMidi::generate(options), true);
+}
+
+void BM_manyTracks(benchmark::State& state) {
+  parseSynthetic(state, {.tracks = static_cast<uint16_t>(state.range(0)),
+                         .eventsPerTrack = 1000});
+}
+BENCHMARK(BM_manyTracks)->RangeMultiplier(4)->Range(16, 4096)->UseRealTime();
+
+void BM_hugeTrack(benchmark::State& state) {
+  auto events = static_cast<size_t>(state.range(0));
+  parseSynthetic(state, {.tracks = 1, .eventsPerTrack = events});
+}
+BENCHMARK(BM_hugeTrack)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->UseRealTime();
+
+void BM_sysExHeavy(benchmark::State& state) {
+  auto size = static_cast<size_t>(state.range(0));
+  parseSynthetic(state, {.tracks = 4,
+                         .eventsPerTrack = (1 << 21) / size,
+                         .sysExRate = 0.5,
+                         .minSysExSize = size / 2,
+                         .maxSysExSize = size});
+}
+BENCHMARK(BM_sysExHeavy)->RangeMultiplier(16)->Range(16, 65536)->UseRealTime();
+
+void BM_runningStatus(benchmark::State& state) {
+  parseSynthetic(state, {.tracks = 16,
+                         .eventsPerTrack = 100'000,
+                         .runningStatus = static_cast<double>(state.range(0))});
+}
+BENCHMARK(BM_runningStatus)
+    ->ArgName("runningStatus")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  registerExamples();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+}
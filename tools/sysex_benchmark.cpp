@@ -0,0 +1,94 @@
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <MidiParser/Parser.hpp>
+#include <MidiParser/read.hpp>
+#include <MidiParser/scan.hpp>
+
+// Usage: sysex_benchmark [events] [max SysEx size]
+//
+// Builds a single-track MIDI file made of SysEx dumps of random size (default
+// 2000 events of up to 8 KiB) and times finding their terminators and
+// parsing the whole file.
+namespace {
+
+template <typename Run>
+void time(const std::string& name, size_t bytes, int iterations, Run&& run) {
+  auto start = std::chrono::steady_clock::now();
+  size_t check = 0;
+  for (int i = 0; i < iterations; ++i) {
+    check += run();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << std::format("{:<34} {:9.1f} MB/s  (check {})\n", name,
+                           double(bytes) * iterations / 1e6 / elapsed.count(),
+                           check);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t events = argc > 1 ? std::stoul(argv[1]) : 2000;
+  uint32_t maxSize = argc > 2 ? uint32_t(std::stoul(argv[2])) : 8192;
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<uint32_t> size(1, maxSize);
+  std::uniform_int_distribution<int> data(0, 0x7F);
+
+  std::vector<uint8_t> track;
+  for (size_t i = 0; i < events; ++i) {
+    track.insert(track.end(), {0x00, 0xF0});
+    for (uint32_t n = size(rng); n > 0; --n) {
+      track.emplace_back(uint8_t(data(rng)));
+    }
+    track.emplace_back(0xF7);
+  }
+  track.insert(track.end(), {0x00, 0xFF, 0x2F, 0x00});
+
+  std::vector<uint8_t> file = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1,
+                               0x01, 0xE0, 'M', 'T', 'r', 'k'};
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    file.emplace_back(uint8_t(track.size() >> shift));
+  }
+  file.insert(file.end(), track.begin(), track.end());
+
+  std::cout << std::format("{} SysEx events, {:.2f} MB, scanner: {}\n",
+                           events, double(file.size()) / 1e6,
+                           MidiParser::scanImplementation());
+
+  const uint8_t* begin = track.data();
+  const uint8_t* end = begin + track.size();
+  auto scanWith = [&](auto find) {
+    size_t found = 0;
+    for (const uint8_t* p = begin; (p = find(p, end, 0xF7)) != end; ++p) {
+      ++found;
+    }
+    return found;
+  };
+  time("find F7, scalar", track.size(), 20,
+       [&] { return scanWith(MidiParser::findByteScalar); });
+  time(std::format("find F7, {}", MidiParser::scanImplementation()),
+       track.size(), 20, [&] { return scanWith(MidiParser::findByte); });
+
+  time("readSysExEvent, byte by byte", track.size(), 5, [&] {
+    size_t bytes = 0;
+    std::vector<uint8_t> copy(track.begin(), track.end());
+    auto it = copy.begin();
+    for (size_t i = 0; i < events; ++i) {
+      ++it;  // Delta time.
+      bytes += MidiParser::readSysExEvent(it, 0).data.size();
+    }
+    return bytes;
+  });
+
+  MidiParser::Parser parser;
+  time("Parser::parseFlat", file.size(), 5, [&] {
+    return parser.parseFlat(std::as_bytes(std::span(file))).tracks[0].payload.size();
+  });
+}
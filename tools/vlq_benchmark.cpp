@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <random>
+#include <stack>
+#include <string>
+#include <vector>
+
+#include <MidiParser/read.hpp>
+#include <MidiParser/vlq.hpp>
+
+// Usage: vlq_benchmark [count]
+//
+// Encodes `count` (default 10 million) variable-length quantities with a
+// delta-time-like size distribution and times decoding all of them.
+namespace {
+
+void encode(uint32_t value, std::vector<uint8_t>& out) {
+  uint8_t buffer[MidiParser::MAX_VLQ_BYTES];
+  int n = 0;
+  do {
+    buffer[n++] = value & 0b01111111;
+    value >>= 7;
+  } while (value != 0);
+  while (n > 1) {
+    out.emplace_back(buffer[--n] | 0b10000000);
+  }
+  out.emplace_back(buffer[0]);
+}
+
+template <typename Decode>
+void run(const std::string& name, const std::vector<uint8_t>& bytes,
+         size_t count, Decode&& decode) {
+  auto start = std::chrono::steady_clock::now();
+  uint64_t sum = decode();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << std::format("{:<28} {:8.2f} ns/value {:10.1f} MB/s  (sum {})\n",
+                           name, elapsed.count() * 1e9 / double(count),
+                           double(bytes.size()) / 1e6 / elapsed.count(), sum);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> size(0, 99);
+  std::vector<uint8_t> bytes;
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t s = size(rng);
+    uint32_t max = s < 70 ? 0x7F : s < 95 ? 0x3FFF : 0x0FFFFFFF;
+    encode(std::uniform_int_distribution<uint32_t>(0, max)(rng), bytes);
+  }
+  const uint8_t* begin = bytes.data();
+  const uint8_t* end = begin + bytes.size();
+
+  run("decodeVlq (bounds checked)", bytes, count, [&] {
+    uint64_t sum = 0;
+    for (const uint8_t* it = begin; it != end;) {
+      sum += MidiParser::decodeVlq(it, end).value_or(0);
+    }
+    return sum;
+  });
+
+  run("readvlq (unchecked)", bytes, count, [&] {
+    uint64_t sum = 0;
+    for (const uint8_t* it = begin; it != end; ++it) {
+      sum += MidiParser::readvlq(it);
+    }
+    return sum;
+  });
+
+  run("std::stack + vlqto32", bytes, count, [&] {
+    uint64_t sum = 0;
+    for (const uint8_t* it = begin; it != end; ++it) {
+      std::stack<uint8_t> s;
+      s.push(*it);
+      while ((*it & 0b10000000) != 0) {
+        s.push(*++it);
+      }
+      sum += MidiParser::vlqto32(s);
+    }
+    return sum;
+  });
+}
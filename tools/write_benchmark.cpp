@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <MidiParser/Parser.hpp>
+#include <MidiParser/Writer.hpp>
+
+// Usage: write_benchmark [--repeat n] <file>...
+//
+// Parses every file once, then serializes all of them `n` times (default 100)
+// into a buffer and into a sink, with and without running status, and prints
+// the output throughput of each.
+namespace {
+
+template <typename Write>
+void run(const std::string& name, size_t repeat, Write&& write) {
+  auto start = std::chrono::steady_clock::now();
+  size_t bytes = 0;
+  for (size_t i = 0; i < repeat; ++i) {
+    bytes += write();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << std::format("{:<32} {:10.1f} MB/s\n", name,
+                           double(bytes) / 1e6 / elapsed.count());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t repeat = 100;
+  std::vector<MidiParser::MidiFile> files;
+  MidiParser::Parser parser;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--repeat" && i + 1 < argc) {
+      repeat = std::stoul(argv[++i]);
+    } else {
+      files.emplace_back(parser.parse(argv[i]));
+    }
+  }
+  if (files.empty()) {
+    std::cerr << "Usage: write_benchmark [--repeat n] <file>...\n";
+    return 1;
+  }
+
+  for (bool runningStatus : {true, false}) {
+    MidiParser::Writer writer({.runningStatus = runningStatus});
+    std::string suffix = runningStatus ? "" : ", no running status";
+
+    run("buffer" + suffix, repeat, [&] {
+      size_t bytes = 0;
+      for (const auto& f : files) {
+        bytes += writer.write(f).size();
+      }
+      return bytes;
+    });
+
+    run("sink" + suffix, repeat, [&] {
+      size_t bytes = 0;
+      for (const auto& f : files) {
+        writer.write(f, [&](std::span<const std::span<const uint8_t>> bufs) {
+          for (auto b : bufs) {
+            bytes += b.size();
+          }
+        });
+      }
+      return bytes;
+    });
+  }
+}